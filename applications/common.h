@@ -54,14 +54,19 @@ setupPotentials(mdtk::SimLoop& simloop)
   simloop.fpot.addPotential(pot);
 #endif
 #ifdef  AIREBO_USING_REBO
-  pot = new mdtk::REBO();
+  REBO* rebo = new mdtk::REBO();
+  pot = rebo;
   simloop.fpot.addPotential(pot);
 #endif
 
   pot = new mdtk::AIREBO((CREBO*)pot);
   simloop.fpot.addPotential(pot);
 
+#ifdef  AIREBO_USING_REBO
+  pot = new mdtk::ETors(rebo);
+#else
   pot = new mdtk::ETors();
+#endif
   simloop.fpot.addPotential(pot);
 
   pot = new mdtk::Ackland();
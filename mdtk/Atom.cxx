@@ -31,20 +31,22 @@ namespace mdtk
 using namespace std;
 
 Atom::Atom(ElementID id, Vector3D Cx, Vector3D Vx)
-  :ID(id),
-   Z(1.0*e),
-   M(1.0*amu),
-   coords(Cx),
-   PBC_count(),
+  :coords(Cx),
    V(Vx),
    an(0.0,0.0,0.0),
-   an_no_tb(0.0,0.0,0.0),
    grad(0.0,0.0,0.0),
+   M(1.0*amu),
+   PBC_count(),
+   fixed(false),
    apply_ThermalBath(true),
    globalIndex(0),
-   fixed(false),
    PBC(NO_PBC),
-   tagbits(0)
+   ID(id),
+   species(0),
+   tagbits(0),
+   an_no_tb(0.0,0.0,0.0),
+   Z(1.0*e),
+   originalIndex(0)
 {
   setAttributesByElementID();
 }
@@ -52,6 +54,7 @@ Atom::Atom(ElementID id, Vector3D Cx, Vector3D Vx)
 Atom::Atom(const Atom &C)
 {
   ID = C.ID;
+  species = C.species;
   Z = C.Z;
   M = C.M;
   coords = C.coords;
@@ -62,6 +65,7 @@ Atom::Atom(const Atom &C)
   grad = C.grad;
   apply_ThermalBath = C.apply_ThermalBath;
   globalIndex = C.globalIndex;
+  originalIndex = C.originalIndex;
   fixed = C.fixed;
   PBC = C.PBC;
   tagbits = C.tagbits;
@@ -73,6 +77,7 @@ Atom::operator=(const Atom &C)
   if (this == &C) return *this;
 
   ID = C.ID;
+  species = C.species;
   Z = C.Z;
   M = C.M;
   coords = C.coords;
@@ -83,6 +88,7 @@ Atom::operator=(const Atom &C)
   grad = C.grad;
   apply_ThermalBath = C.apply_ThermalBath;
   globalIndex = C.globalIndex;
+  originalIndex = C.originalIndex;
   fixed = C.fixed;
   PBC = C.PBC;
   tagbits = C.tagbits;
@@ -199,6 +205,7 @@ operator>>(istream& is, Atom& a)
   if (is)
   {
     a.ID = ElementID(ID);
+    a.species = ElementIDtoSpecies(a.ID);
     a.Z = Z;
     a.M = M;
     a.coords = coords;
@@ -32,36 +32,49 @@ namespace mdtk
 class Atom
 {
 public:
-  ElementID ID;
-
-  Float Z;
-  Float M;
-  void setAttributesByElementID();
-
+/*
+  The fields are grouped by use rather than by meaning: the integrator
+  and the force loops stream over the atoms every step, so what they
+  read comes first and shares as few cache lines as possible, the rest
+  is kept at the end.
+*/
   Vector3D coords;
-  IntVector3D PBC_count;
-  void applyPBC();
-  void unfoldPBC();
-
   Vector3D V;
-
   Vector3D an;
-  Vector3D an_no_tb;
   Vector3D grad;
 
-  bool apply_ThermalBath;
-
-  size_t globalIndex;
+  Float M;
+  IntVector3D PBC_count;
+  void applyPBC();
+  void unfoldPBC();
 
   bool fixed;
   bool isFixed() const { return fixed; }
   void fix() { fixed = true; V=0.0; an=0.0; an_no_tb=0.0; }
   void unfix() { fixed = false; V=0.0; an=0.0; an_no_tb=0.0; }
 
+  bool apply_ThermalBath;
+
+  size_t globalIndex;
+
   Vector3D PBC;
   bool PBCEnabled()const{return PBC != NO_PBC;};
   bool lateralPBCEnabled()const{return PBC.x != NO_PBC && PBC.y != NO_PBC;};
 
+  ElementID ID;
+// ElementIDtoSpecies(ID), set by setAttributesByElementID()
+  unsigned char species;
+  unsigned int tagbits;
+
+  Vector3D an_no_tb;
+
+  Float Z;
+  void setAttributesByElementID();
+
+// index in the order the atoms were given in, kept when the array is
+// reordered for the simulation
+  size_t originalIndex;
+
   Atom(ElementID id=H_EL, Vector3D Cx=Vector3D(0,0,0), Vector3D Vx=Vector3D(0,0,0));
 
   Atom(const Atom &C);
@@ -79,8 +92,6 @@ public:
   friend bool operator>=(const Atom& v1, const Atom& v2);
   friend bool operator<=(const Atom& v1, const Atom& v2);
 
-  unsigned int tagbits;
-
 #define ATOMTAG_EXAMPLE (1<<0)
 #define ATOMTAG_TARGET (1<<1)
 #define ATOMTAG_PROJECTILE (1<<2)
@@ -99,6 +110,7 @@ inline
 void
 Atom::setAttributesByElementID()
 {
+  species = ElementIDtoSpecies(ID);
   switch (ID)
   {
     case H_EL  : Z =   1.0*e; M =   1.0*amu; break;
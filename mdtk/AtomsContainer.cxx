@@ -21,6 +21,8 @@
 */
 
 #include <mdtk/AtomsContainer.hpp>
+#include <algorithm>
+#include <stdint.h>
 
 namespace mdtk
 {
@@ -112,6 +114,7 @@ AtomsArray::prepareForSimulatation()
 //    at(i).PBC = arrayPBC;
     at(i).applyPBC();
     at(i).globalIndex = i;
+    at(i).originalIndex = i;
     at(i).setAttributesByElementID();
   }
 
@@ -129,6 +132,145 @@ AtomsArray::setAttributesByElementID()
     at(i).setAttributesByElementID();
 }
 
+/*
+  Moves the atom at order[i] to the position i. The permutation is
+  applied cycle by cycle within the storage of the array, with a single
+  atom held aside per cycle, so the storage is neither copied nor
+  reallocated.
+*/
+void
+AtomsArray::reorder(const std::vector<size_t>& order)
+{
+  REQUIRE(order.size() == size());
+  std::vector<char> placed(size(),false);
+  for(size_t i = 0; i < size(); i++)
+  {
+    if (placed[i]) continue;
+    placed[i] = true;
+    if (order[i] == i) continue;
+    Atom held(at(i));
+    size_t j = i;
+    for(size_t k = order[j]; k != i; k = order[j])
+    {
+      REQUIRE(k < size() && !placed[k]);
+      at(j) = at(k);
+      placed[k] = true;
+      j = k;
+    }
+    at(j) = held;
+  }
+  for(size_t i = 0; i < size(); i++)
+    at(i).globalIndex = i;
+}
+
+namespace
+{
+
+inline
+uint64_t
+spreadBits(uint64_t v)
+{
+  v &= 0x1fffff;
+  v = (v | v << 32) & 0x1f00000000ffffULL;
+  v = (v | v << 16) & 0x1f0000ff0000ffULL;
+  v = (v | v << 8)  & 0x100f00f00f00f00fULL;
+  v = (v | v << 4)  & 0x10c30c30c30c30c3ULL;
+  v = (v | v << 2)  & 0x1249249249249249ULL;
+  return v;
+}
+
+}
+
+/*
+  Sorts the atoms along the Z-order (Morton) curve through the cells of
+  the given size, so that the atoms of a cell and of the cells around it
+  mostly lie close to each other in memory.
+*/
+void
+AtomsArray::reorderByMortonKey(Float cellSize)
+{
+  REQUIRE(cellSize > 0.0);
+  if (size() == 0) return;
+
+  Vector3D lo = at(0).coords;
+  for(size_t i = 1; i < size(); i++)
+    for(int c = 0; c < 3; c++)
+      if (lo.X(c) > at(i).coords.X(c)) lo.X(c) = at(i).coords.X(c);
+
+  const Float cellMax = 0x1fffff;
+  std::vector<std::pair<uint64_t,size_t> > keys(size());
+  for(size_t i = 0; i < size(); i++)
+  {
+    uint64_t key = 0;
+    for(int c = 0; c < 3; c++)
+    {
+      Float cell = floor((at(i).coords.X(c)-lo.X(c))/cellSize);
+      if (cell > cellMax) cell = cellMax;
+      key |= spreadBits(uint64_t(cell)) << c;
+    }
+    keys[i] = std::make_pair(key,i);
+  }
+  std::sort(keys.begin(),keys.end());
+
+  std::vector<size_t> order(size());
+  for(size_t i = 0; i < size(); i++)
+    order[i] = keys[i].second;
+  reorder(order);
+}
+
+/*
+  Positions of the atoms in their original order. Atoms added or removed
+  since the array was prepared leave the original indices incomplete, the
+  current order is then taken as the original one.
+*/
+std::vector<size_t>
+AtomsArray::originalOrder() const
+{
+  std::vector<size_t> order(size(),size());
+  for(size_t i = 0; i < size(); i++)
+  {
+    size_t oi = at(i).originalIndex;
+    if (oi >= size() || order[oi] != size())
+    {
+      for(size_t k = 0; k < size(); k++)
+        order[k] = k;
+      break;
+    }
+    order[oi] = i;
+  }
+  return order;
+}
+
+bool
+AtomsArray::restoreOriginalOrder()
+{
+  std::vector<size_t> order = originalOrder();
+  bool reordered = false;
+  for(size_t i = 0; i < size(); i++)
+    if (order[i] != i)
+      reordered = true;
+  if (reordered)
+    reorder(order);
+  return reordered;
+}
+
+AtomsOriginalOrderScope::AtomsOriginalOrderScope(AtomsArray& a)
+  :atoms(a),
+   order()
+{
+  order.resize(atoms.size());
+  for(size_t i = 0; i < atoms.size(); i++)
+    order[i] = atoms[i].originalIndex;
+  if (!atoms.restoreOriginalOrder())
+    order.clear();
+}
+
+AtomsOriginalOrderScope::~AtomsOriginalOrderScope()
+{
+  if (!order.empty())
+    atoms.reorder(order);
+}
+
 AtomsArray::AtomsArray(size_t size)
   :std::vector<Atom>(size),
    arrayPBC(NO_PBC)
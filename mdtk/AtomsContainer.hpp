@@ -28,6 +28,12 @@
 namespace mdtk
 {
 
+/*
+  The atoms may be reordered during a simulation to keep the ones close
+  in space close in memory. globalIndex always follows the position in
+  the array, while originalIndex keeps the position the atom had when
+  the simulation was prepared.
+*/
 class AtomsArray:public std::vector<Atom>
 {
   friend class SimLoopSaver;
@@ -46,6 +52,11 @@ public:
   void prepareForSimulatation();
   void setAttributesByElementID();
 
+  void reorder(const std::vector<size_t>& order);
+  void reorderByMortonKey(Float cellSize);
+  std::vector<size_t> originalOrder() const;
+  bool restoreOriginalOrder();
+
   AtomsArray(size_t size = 0);
   AtomsArray(const AtomsArray &c);
   AtomsArray& operator =(const AtomsArray &c);
@@ -103,6 +114,22 @@ public:
   void clearTags();
 };
 
+/*
+  Puts the atoms back into their original order for the lifetime of the
+  object, e.g. while files are written, and reinstates the current order
+  afterwards. The atoms are permuted within the storage of the array, so
+  references to atoms taken before the scope refer to the same atoms
+  again once it ends.
+*/
+class AtomsOriginalOrderScope
+{
+  AtomsArray& atoms;
+  std::vector<size_t> order;
+public:
+  AtomsOriginalOrderScope(AtomsArray& a);
+  ~AtomsOriginalOrderScope();
+};
+
 class AtomRefsContainer:public std::vector<Atom*>
 {
 public:
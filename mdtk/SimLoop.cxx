@@ -60,7 +60,10 @@ SimLoop::SimLoop()
     allowPartialLoading(false),
     fpot(),
     CPUTimeUsed_prev(0),
-    CPUTimeUsed_total(0)
+    CPUTimeUsed_total(0),
+    positions(),
+    velocities(),
+    accelerations()
 {
   check.checkEnergy = true;
   check.checkForce = true;
@@ -88,7 +91,10 @@ SimLoop::SimLoop(const SimLoop &c)
     allowPartialLoading(false),
     fpot(),
     CPUTimeUsed_prev(0),
-    CPUTimeUsed_total(0)
+    CPUTimeUsed_total(0),
+    positions(),
+    velocities(),
+    accelerations()
 {
   check.checkEnergy = true;
   check.checkForce = true;
@@ -176,6 +182,7 @@ SimLoop::execute()
   catch (Exception& e)
   {
     std::cerr << "Caught mdtk Exception: " << e.what() << std::endl;
+    atoms.restoreOriginalOrder();
     {
       yaatk::text_ofstream fo2("completed.error");
       fo2.close();
@@ -198,6 +205,7 @@ SimLoop::execute()
   catch (MPI_Exception& e)
   {
     std::cerr << "Caught MPI Exception: " << e.what() << std::endl;
+    atoms.restoreOriginalOrder();
     std::cerr << "Flushing state.....";
     writestate();
     std::cerr << "done." << std::endl;
@@ -247,7 +255,7 @@ SimLoop::executeMain()
   dt_prev = dt;
 
   fpot.NL_init(atoms);
-  fpot.NL_UpdateIfNeeded(atoms);
+  fpot.NL_UpdateIfNeeded(atoms,true);
 
   while (simTime < simTimeFinal && !breakSimLoop)
   {
@@ -288,20 +296,6 @@ SimLoop::executeMain()
 
     Float v_max = 0.0;
 
-    for(size_t j = 0; j < atoms.size(); j++)
-    {
-      Atom& atom = atoms[j];
-
-      atom.grad = 0;
-
-      if (atom.isFixed())
-      {
-        REQUIRE(atom.an == Vector3D(0.0,0.0,0.0));
-        REQUIRE(atom.an_no_tb == Vector3D(0.0,0.0,0.0));
-        REQUIRE(atom.V == Vector3D(0.0,0.0,0.0));
-      }
-    }
-
     if (iteration == 0)
     {
       initEnergyConservationCheck();
@@ -320,19 +314,46 @@ SimLoop::executeMain()
       }
     }
 
+    positions.resize(atoms.size());
+    velocities.resize(atoms.size());
+    accelerations.resize(atoms.size());
+
     for(size_t j = 0; j < atoms.size(); j++)
     {
       Atom& atom = atoms[j];
 
-      if (atom.isFixed()) continue;
+      atom.grad = 0;
+
+      if (atom.isFixed())
+      {
+        REQUIRE(atom.an == Vector3D(0.0,0.0,0.0));
+        REQUIRE(atom.an_no_tb == Vector3D(0.0,0.0,0.0));
+        REQUIRE(atom.V == Vector3D(0.0,0.0,0.0));
+      }
+
+      positions[j] = atom.coords;
+      velocities[j] = atom.V;
+      accelerations[j] = atom.an;
+    }
 
-      Vector3D dr = atom.V*dt + atom.an*dt*dt/2.0; // eq 1
-      atom.coords += dr;
+// fixed atoms have zero velocities and accelerations, so they do not move
+    for(size_t j = 0; j < positions.size(); j++)
+    {
+      Vector3D dr = velocities[j]*dt + accelerations[j]*dt*dt/2.0; // eq 1
+      positions[j] += dr;
       fpot.incDisplacement(atoms[j],dr);
     }
 
+    for(size_t j = 0; j < atoms.size(); j++)
+    {
+      Atom& atom = atoms[j];
+      if (atom.isFixed()) continue;
+      atom.coords = positions[j];
+    }
+
     fpot.NL_checkRequestUpdate(atoms);
-    fpot.NL_UpdateIfNeeded(atoms);
+    fpot.nlSkinTuner.simTime = simTime + dt;
+    fpot.NL_UpdateIfNeeded(atoms,true);
 
     doEnergyConservationCheck();
 
@@ -347,7 +368,10 @@ SimLoop::executeMain()
 
       if (atom.isFixed()) continue;
 
-      Vector3D  vdt2 = atom.V + atom.an*dt/2.0; // eq 2
+      Vector3D& V = velocities[j];
+      Vector3D& an = accelerations[j];
+
+      Vector3D  vdt2 = V + an*dt/2.0; // eq 2
 
       if (thermalBathShouldBeApplied(atom))
       {
@@ -358,7 +382,7 @@ SimLoop::executeMain()
         if (To_by_T < -max_To_by_T) To_by_T = -max_To_by_T;
         if (To_by_T > +max_To_by_T) To_by_T = +max_To_by_T;
 
-        Vector3D dforce = -atom.V*atom.M*thermalBathCommon.gamma*(1.0-sqrt(To_by_T));
+        Vector3D dforce = -V*atom.M*thermalBathCommon.gamma*(1.0-sqrt(To_by_T));
 
         // try to account energy transfered to thermalbath
         // only required to perform energy conservation check
@@ -375,29 +399,36 @@ SimLoop::executeMain()
           {
             Vector3D an_new = (force + dforce)/atom.M;
             // from eq 2 and eq 4
-            dv = atom.an*dt/2.0 + an_new*dt/2.0;
-            atom.an = an_new;
+            dv = an*dt/2.0 + an_new*dt/2.0;
+            an = an_new;
           }
 
-          Float dEkin = atom.M*SQR((atom.V+dv)      .module())/2.0
-                      - atom.M*SQR((atom.V+dv_no_tb).module())/2.0;
+          Float dEkin = atom.M*SQR((V+dv)      .module())/2.0
+                      - atom.M*SQR((V+dv_no_tb).module())/2.0;
           check.energyTransferredFromBath += dEkin;
         }
 
         force += dforce;
       }
 
-      atom.an = force/atom.M; //eq 3
+      an = force/atom.M; //eq 3
 
-      atom.V  = vdt2 + atom.an*dt/2.0; //eq 4
+      V  = vdt2 + an*dt/2.0; //eq 4
 
-      Float v = atom.V.module();
+      Float v = V.module();
       if (v > v_max &&
           fpot.hasNeighbors(atom)
          )
         v_max = v;
     }
 
+    for(size_t j = 0; j < atoms.size(); j++)
+    {
+      Atom& atom = atoms[j];
+      atom.V = velocities[j];
+      atom.an = accelerations[j];
+    }
+
     atoms.applyPBC();
 
     doAfterIteration();
@@ -464,6 +495,12 @@ SimLoop::executeMain()
     if (verboseTrace) cout << "done. " << endl;
   }
 
+  if (atoms.restoreOriginalOrder())
+  {
+    fpot.NL_init(atoms);
+    fpot.NL_UpdateIfNeeded(atoms);
+  }
+
   curWallTime = time(NULL);
   if (verboseTrace)
     cout << "Wall TIME used = " << (curWallTime-startWallTime) << endl;
@@ -808,6 +845,8 @@ SimLoop::writetraj()
 {
   if (preventFileOutput) return;
 
+  AtomsOriginalOrderScope originalOrder(atoms);
+
   yaatk::DataState ds;
 
   static char s[1024];
@@ -822,6 +861,8 @@ SimLoop::writetrajXVA()
 {
   if (preventFileOutput) return;
 
+  AtomsOriginalOrderScope originalOrder(atoms);
+
   yaatk::DataState ds;
 
   static char s[1024];
@@ -836,6 +877,8 @@ SimLoop::writetrajXVA_bin()
 {
   if (preventFileOutput) return;
 
+  AtomsOriginalOrderScope originalOrder(atoms);
+
   yaatk::DataState ds;
 
   static char s[1024];
@@ -850,6 +893,8 @@ SimLoop::writetrajXYZ()
 {
   if (preventFileOutput) return;
 
+  AtomsOriginalOrderScope originalOrder(atoms);
+
   yaatk::DataState ds;
 
   static char s[1024];
@@ -876,6 +921,8 @@ SimLoop::writetrajAccumulated(const std::vector<size_t>& atomIndices)
 {
   if (preventFileOutput) return;
 
+  AtomsOriginalOrderScope originalOrder(atoms);
+
   yaatk::DataState ds;
 
   Float XVA_VELOCITY_SCALE = 0.0;//1.0e3;
@@ -992,6 +1039,8 @@ SimLoop::writetrajAccumulated_bin(const std::vector<size_t>& atomIndices)
 {
   if (preventFileOutput) return;
 
+  AtomsOriginalOrderScope originalOrder(atoms);
+
   yaatk::DataState ds;
 
   yaatk::binary_ifstream accPrev("acc.bin");
@@ -1085,6 +1134,8 @@ SimLoop::writestate()
 {
   if (preventFileOutput) return;
 
+  AtomsOriginalOrderScope originalOrder(atoms);
+
   mdtk::SimLoopSaver mds(*this);
   mds.write();
 
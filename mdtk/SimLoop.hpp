@@ -233,6 +233,16 @@ public:
 private:
   double CPUTimeUsed_prev;
   double CPUTimeUsed_total;
+/*
+  Positions, velocities and accelerations of the atoms, laid out for
+  the integrator to stream over. The atoms remain the master copy: the
+  arrays are loaded from them at every step, the positions are written
+  back before the forces are evaluated, and the velocities and the
+  accelerations after they are updated.
+*/
+  std::vector<Vector3D> positions;
+  std::vector<Vector3D> velocities;
+  std::vector<Vector3D> accelerations;
 public:
   // these functions are obsolete
   void setPBC(Vector3D PBC_){atoms.PBC(PBC_);}
@@ -87,9 +87,10 @@ struct SnapshotList
   void initSelectedAtomList(const SimLoop& sl)
     {
       atomsSelectedForSaving.clear();
+      std::vector<size_t> order = sl.atoms.originalOrder();
       for(size_t ai = 0; ai < sl.atoms.size(); ++ai)
-        if (sl.atoms[ai].hasTag(ATOMTAG_PROJECTILE) ||
-            sl.atoms[ai].hasTag(ATOMTAG_CLUSTER))
+        if (sl.atoms[order[ai]].hasTag(ATOMTAG_PROJECTILE) ||
+            sl.atoms[order[ai]].hasTag(ATOMTAG_CLUSTER))
           atomsSelectedForSaving.push_back(ai);
     }
   SnapshotList():
@@ -108,10 +109,11 @@ struct SnapshotList
         initialized = true;
       }
       SelectedAtomSnapshotList alist;
+      std::vector<size_t> order = sl.atoms.originalOrder();
       for(size_t i = 0; i < atomsSelectedForSaving.size(); ++i)
       {
         REQUIRE(atomsSelectedForSaving[i] < sl.atoms.size());
-        alist.push_back(AtomSnapshot(sl.atoms[atomsSelectedForSaving[i]]));
+        alist.push_back(AtomSnapshot(sl.atoms[order[atomsSelectedForSaving[i]]]));
       }
       bool alreadyAccounted = false;
       for(size_t i = 0; i < snapshots.size(); ++i)
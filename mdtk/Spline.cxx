@@ -37,64 +37,16 @@ Spline::init(
          Float    dvdx[2]
 )
 {
-{
-  size_t N = 1;
-
-  SplineMultiD Fv(N);
-
-  SplineMultiD Fdvdx(N);
-
-  Fdvdx.differentiate(0);
-
-/*
-  f.bounds[0][0] = x[0];
-  f.bounds[0][1] = x[1];
-  f.bounds[1][0] = y[0];
-  f.bounds[1][1] = y[1];
-  f.bounds[2][0] = z[0];
-  f.bounds[2][1] = z[1];
-*/
-
-std::vector<std::vector<Float> > xvs; std::vector<Float> fvs;
-
-  std::vector<Float> xv;
-  xv.resize(N);
- 
-  Float fv;
-
-#define FILL(VFUN,i1) \
-{ \
-  xv[0] = x[i1]; \
-  fv = VFUN[i1]; \
-  addEquation(F##VFUN,xv,fv,xvs,fvs); \
-}
-
-for(size_t i1 = 0; i1 < 2; i1++)
-  FILL(v,i1);
-
-for(size_t i1 = 0; i1 < 2; i1++)
-  FILL(dvdx,i1);
-
-#define FILL0(VFUN,i1) \
-{ \
-  xv[0] = x[i1]; \
-  fv = 0.0; \
-  addEquation(F##VFUN,xv,fv,xvs,fvs); \
-}
+  Float b[4][4];
+  cubicHermiteBasis(x[1]-x[0],b);
 
-  f.addEquations(xvs,fvs);
-
-}
-
-  dfdx = f;
-
-  dfdx.differentiate(0);
+  for(int p = 0; p < 4; p++)
+    c_[p] = v[0]*b[0][p] + v[1]*b[1][p] + dvdx[0]*b[2][p] + dvdx[1]*b[3][p];
 
   for(int i = 0;i < 2;i++)
   {
     x_[i] = x[i];
   }  
-
 }
 
 }
@@ -34,8 +34,7 @@ namespace mdtk
 class Spline
 {
 private:
-  SplineMultiD f;
-  SplineMultiD dfdx;
+  Float  c_[4];
   Float  x_[2];
 public:
   Float operator()(Float x) const;
@@ -49,7 +48,7 @@ public:
          Float       x[2],
          Float       v[2],
          Float    dvdx[2]
-  ): f(1), dfdx(1) {init(x,v,dvdx);};
+  ) {init(x,v,dvdx);};
   virtual ~Spline() {}
 
   Float x1() const {return x_[0];};
@@ -57,16 +56,16 @@ public:
 
   void SaveToStream(std::ostream& os, YAATK_FSTREAM_MODE smode)
   {
-    f.SaveToStream(os,smode);
-    dfdx.SaveToStream(os,smode);
+    for(int i = 0;i < 4;i++)
+      YAATK_FSTREAM_WRITE(os,c_[i],smode);
 
     YAATK_FSTREAM_WRITE(os,x_[0],smode);
     YAATK_FSTREAM_WRITE(os,x_[1],smode);
   }  
   void LoadFromStream(std::istream& is, YAATK_FSTREAM_MODE smode)
   {
-    f.LoadFromStream(is,smode);
-    dfdx.LoadFromStream(is,smode);
+    for(int i = 0;i < 4;i++)
+      YAATK_FSTREAM_READ(is,c_[i],smode);
 
     YAATK_FSTREAM_READ(is,x_[0],smode);
     YAATK_FSTREAM_READ(is,x_[1],smode);
@@ -77,18 +76,14 @@ inline
 Float
 Spline::operator()(Float x) const
 {
-  std::vector<Float> xv(1);
-  xv[0] = x;
-  return f(xv);
+  return cubicValue(c_,x-x_[0]);
 }
 
 inline
 Float
 Spline::der(Float x) const
 {
-  std::vector<Float> xv(1);
-  xv[0] = x;
-  return dfdx(xv);
+  return cubicDerivative(c_,x-x_[0]);
 }
 
 } 
@@ -32,6 +32,10 @@ using std::sqrt;
 using std::pow;
 
 
+/*
+  With the cross derivative vanishing at the corners, the bicubic is the
+  tensor product of the cubic Hermite bases in x and y.
+*/
 void
 Spline2D::init(
          Float       x[2],
@@ -41,87 +45,28 @@ Spline2D::init(
          Float dvdy[2][2]
          )
 {
+  Float bx[4][4];
+  Float by[4][4];
+  cubicHermiteBasis(x[1]-x[0],bx);
+  cubicHermiteBasis(y[1]-y[0],by);
 
-{
-  size_t N = 2;
-
-  SplineMultiD Fv(N);
-
-  SplineMultiD Fdvdx(N);
-  SplineMultiD Fdvdy(N);
-
-  Fdvdx.differentiate(0);
-  Fdvdy.differentiate(1);
-
-  SplineMultiD Fd2vdxdy(N);
-
-  Fd2vdxdy.differentiate(0);Fd2vdxdy.differentiate(1);
-
-/*
-  f.bounds[0][0] = x[0];
-  f.bounds[0][1] = x[1];
-  f.bounds[1][0] = y[0];
-  f.bounds[1][1] = y[1];
-  f.bounds[2][0] = z[0];
-  f.bounds[2][1] = z[1];
-*/
-
-std::vector<std::vector<Float> > xvs; std::vector<Float> fvs;
-
-  std::vector<Float> xv;
-  xv.resize(N);
- 
-  Float fv;
-
-#define FILL(VFUN,i1,i2) \
-{ \
-  xv[0] = x[i1]; \
-  xv[1] = y[i2]; \
-  fv = VFUN[i1][i2]; \
-  addEquation(F##VFUN,xv,fv,xvs,fvs); \
-}
-
-for(size_t i1 = 0; i1 < 2; i1++)
-for(size_t i2 = 0; i2 < 2; i2++)
-  FILL(v,i1,i2);
-
-for(size_t i1 = 0; i1 < 2; i1++)
-for(size_t i2 = 0; i2 < 2; i2++)
-  FILL(dvdx,i1,i2);
-
-for(size_t i1 = 0; i1 < 2; i1++)
-for(size_t i2 = 0; i2 < 2; i2++)
-  FILL(dvdy,i1,i2);
-
-#define FILL0(VFUN,i1,i2) \
-{ \
-  xv[0] = x[i1]; \
-  xv[1] = y[i2]; \
-  fv = 0.0; \
-  addEquation(F##VFUN,xv,fv,xvs,fvs); \
-}
-
-for(size_t i1 = 0; i1 < 2; i1++)
-for(size_t i2 = 0; i2 < 2; i2++)
-  FILL0(d2vdxdy,i1,i2);
-
-
-  f.addEquations(xvs,fvs);
-
-}
-
-  dfdx = f;
-  dfdy = f;
-
-  dfdx.differentiate(0);
-  dfdy.differentiate(1);
+  for(int p = 0; p < 4; p++)
+  for(int q = 0; q < 4; q++)
+  {
+    Float c = 0.0;
+    for(int a = 0; a < 2; a++)
+    for(int b = 0; b < 2; b++)
+      c +=    v[a][b]*bx[a  ][p]*by[b  ][q]
+        +  dvdx[a][b]*bx[a+2][p]*by[b  ][q]
+        +  dvdy[a][b]*bx[a  ][p]*by[b+2][q];
+    c_[p][q] = c;
+  }
 
   for(int i = 0;i < 2;i++)
   {
     x_[i] = x[i];
     y_[i] = y[i];
   }  
-
 }
 
 }
@@ -34,13 +34,12 @@ namespace mdtk
 class Spline2D
 {
 private:
-  SplineMultiD f;
-  SplineMultiD dfdx;
-  SplineMultiD dfdy;
+  Float  c_[4][4];
   Float  x_[2];
   Float  y_[2];
 public:
   Float operator()(Float x, Float y) const;
+  Float operator()(Float x, Float y, Float& dfdx, Float& dfdy) const;
   Float dx(Float x, Float y) const;
   Float dy(Float x, Float y) const;
   void init(
@@ -57,16 +56,15 @@ public:
          Float dvdx[2][2],
          Float dvdy[2][2]
          )
-  : f(2), dfdx(2), dfdy(2) {init(x,y,v,dvdx,dvdy);}
-  Spline2D() : f(2), dfdx(2), dfdy(2){};
+  {init(x,y,v,dvdx,dvdy);}
+  Spline2D() {};
   virtual ~Spline2D() {}
   
   void SaveToStream(std::ostream& os, YAATK_FSTREAM_MODE smode)
   {
     int i;
-    f.SaveToStream(os,smode);
-    dfdx.SaveToStream(os,smode);
-    dfdy.SaveToStream(os,smode);
+    for(i = 0;i < 16;i++)
+      YAATK_FSTREAM_WRITE(os,c_[i/4][i%4],smode);
 
     for(i = 0;i < 2;i++)
       YAATK_FSTREAM_WRITE(os,x_[i],smode);
@@ -76,9 +74,8 @@ public:
   void LoadFromStream(std::istream& is, YAATK_FSTREAM_MODE smode)
   {
     int i;
-    f.LoadFromStream(is,smode);
-    dfdx.LoadFromStream(is,smode);
-    dfdy.LoadFromStream(is,smode);
+    for(i = 0;i < 16;i++)
+      YAATK_FSTREAM_READ(is,c_[i/4][i%4],smode);
 
     for(i = 0;i < 2;i++)
       YAATK_FSTREAM_READ(is,x_[i],smode);
@@ -92,30 +89,55 @@ inline
 Float
 Spline2D::operator()(Float x, Float y) const
 {
-  std::vector<Float> xv(2);
-  xv[0] = x;
-  xv[1] = y;
-  return f(xv);
+  x -= x_[0];
+  y -= y_[0];
+  Float p[4];
+  for(int i = 0; i < 4; i++)
+    p[i] = cubicValue(c_[i],y);
+  return cubicValue(p,x);
+}
+
+// the value and both derivatives at once
+inline
+Float
+Spline2D::operator()(Float x, Float y, Float& dfdx, Float& dfdy) const
+{
+  x -= x_[0];
+  y -= y_[0];
+  Float p[4];
+  Float py[4];
+  for(int i = 0; i < 4; i++)
+  {
+    p[i] = cubicValue(c_[i],y);
+    py[i] = cubicDerivative(c_[i],y);
+  }
+  dfdx = cubicDerivative(p,x);
+  dfdy = cubicValue(py,x);
+  return cubicValue(p,x);
 }
 
 inline
 Float
 Spline2D::dx(Float x, Float y) const
 {
-  std::vector<Float> xv(2);
-  xv[0] = x;
-  xv[1] = y;
-  return dfdx(xv);
+  x -= x_[0];
+  y -= y_[0];
+  Float p[4];
+  for(int i = 0; i < 4; i++)
+    p[i] = cubicValue(c_[i],y);
+  return cubicDerivative(p,x);
 }
 
 inline
 Float
 Spline2D::dy(Float x, Float y) const
 {
-  std::vector<Float> xv(2);
-  xv[0] = x;
-  xv[1] = y;
-  return dfdy(xv);
+  x -= x_[0];
+  y -= y_[0];
+  Float p[4];
+  for(int i = 0; i < 4; i++)
+    p[i] = cubicDerivative(c_[i],y);
+  return cubicValue(p,x);
 }
 
 
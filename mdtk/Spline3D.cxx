@@ -31,6 +31,10 @@ using std::sqrt;
 using std::pow;
 
 
+/*
+  With the mixed derivatives vanishing at the corners, the tricubic is
+  the tensor product of the cubic Hermite bases in x, y and z.
+*/
 void
 Spline3D::init(
          Float          x[2],
@@ -42,116 +46,27 @@ Spline3D::init(
          Float dvdz[2][2][2]
          )
 {
-
-{
-  size_t N = 3;
-
-  SplineMultiD Fv(N);
-
-  SplineMultiD Fdvdx(N);
-  SplineMultiD Fdvdy(N);
-  SplineMultiD Fdvdz(N);
-
-  Fdvdx.differentiate(0);
-  Fdvdy.differentiate(1);
-  Fdvdz.differentiate(2);
-
-  SplineMultiD Fd2vdxdy(N);
-  SplineMultiD Fd2vdxdz(N);
-  SplineMultiD Fd2vdydz(N);
-
-  Fd2vdxdy.differentiate(0);Fd2vdxdy.differentiate(1);
-  Fd2vdxdz.differentiate(0);Fd2vdxdz.differentiate(2);
-  Fd2vdydz.differentiate(1);Fd2vdydz.differentiate(2);
-
-  SplineMultiD Fd3vdxdydz(N);
-  Fd3vdxdydz.differentiate(0);Fd3vdxdydz.differentiate(1);Fd3vdxdydz.differentiate(2);
-
-/*
-  f.bounds[0][0] = x[0];
-  f.bounds[0][1] = x[1];
-  f.bounds[1][0] = y[0];
-  f.bounds[1][1] = y[1];
-  f.bounds[2][0] = z[0];
-  f.bounds[2][1] = z[1];
-*/
-
-std::vector<std::vector<Float> > xvs; std::vector<Float> fvs;
-
-  std::vector<Float> xv;
-  xv.resize(N);
- 
-  Float fv;
-
-#define FILL(VFUN,i1,i2,i3) \
-{ \
-  xv[0] = x[i1]; \
-  xv[1] = y[i2]; \
-  xv[2] = z[i3]; \
-  fv = VFUN[i1][i2][i3]; \
-  addEquation(F##VFUN,xv,fv,xvs,fvs); \
-}
-
-for(size_t i1 = 0; i1 < 2; i1++)
-for(size_t i2 = 0; i2 < 2; i2++)
-for(size_t i3 = 0; i3 < 2; i3++)
-  FILL(v,i1,i2,i3);
-
-for(size_t i1 = 0; i1 < 2; i1++)
-for(size_t i2 = 0; i2 < 2; i2++)
-for(size_t i3 = 0; i3 < 2; i3++)
-  FILL(dvdx,i1,i2,i3);
-
-for(size_t i1 = 0; i1 < 2; i1++)
-for(size_t i2 = 0; i2 < 2; i2++)
-for(size_t i3 = 0; i3 < 2; i3++)
-  FILL(dvdy,i1,i2,i3);
-
-for(size_t i1 = 0; i1 < 2; i1++)
-for(size_t i2 = 0; i2 < 2; i2++)
-for(size_t i3 = 0; i3 < 2; i3++)
-  FILL(dvdz,i1,i2,i3);
-
-#define FILL0(VFUN,i1,i2,i3) \
-{ \
-  xv[0] = x[i1]; \
-  xv[1] = y[i2]; \
-  xv[2] = z[i3]; \
-  fv = 0.0; \
-  addEquation(F##VFUN,xv,fv,xvs,fvs); \
-}
-
-for(size_t i1 = 0; i1 < 2; i1++)
-for(size_t i2 = 0; i2 < 2; i2++)
-for(size_t i3 = 0; i3 < 2; i3++)
-  FILL0(d2vdxdy,i1,i2,i3);
-
-for(size_t i1 = 0; i1 < 2; i1++)
-for(size_t i2 = 0; i2 < 2; i2++)
-for(size_t i3 = 0; i3 < 2; i3++)
-  FILL0(d2vdxdz,i1,i2,i3);
-
-for(size_t i1 = 0; i1 < 2; i1++)
-for(size_t i2 = 0; i2 < 2; i2++)
-for(size_t i3 = 0; i3 < 2; i3++)
-  FILL0(d2vdydz,i1,i2,i3);
-
-for(size_t i1 = 0; i1 < 2; i1++)
-for(size_t i2 = 0; i2 < 2; i2++)
-for(size_t i3 = 0; i3 < 2; i3++)
-  FILL0(d3vdxdydz,i1,i2,i3);
-
-  f.addEquations(xvs,fvs);
-
-}
-
-  dfdx = f;
-  dfdy = f;
-  dfdz = f;
-
-  dfdx.differentiate(0);
-  dfdy.differentiate(1);
-  dfdz.differentiate(2);
+  Float bx[4][4];
+  Float by[4][4];
+  Float bz[4][4];
+  cubicHermiteBasis(x[1]-x[0],bx);
+  cubicHermiteBasis(y[1]-y[0],by);
+  cubicHermiteBasis(z[1]-z[0],bz);
+
+  for(int p = 0; p < 4; p++)
+  for(int q = 0; q < 4; q++)
+  for(int r = 0; r < 4; r++)
+  {
+    Float c = 0.0;
+    for(int a = 0; a < 2; a++)
+    for(int b = 0; b < 2; b++)
+    for(int d = 0; d < 2; d++)
+      c +=    v[a][b][d]*bx[a  ][p]*by[b  ][q]*bz[d  ][r]
+        +  dvdx[a][b][d]*bx[a+2][p]*by[b  ][q]*bz[d  ][r]
+        +  dvdy[a][b][d]*bx[a  ][p]*by[b+2][q]*bz[d  ][r]
+        +  dvdz[a][b][d]*bx[a  ][p]*by[b  ][q]*bz[d+2][r];
+    c_[p][q][r] = c;
+  }
 
   for(int i = 0;i < 2;i++)
   {
@@ -159,9 +74,7 @@ for(size_t i3 = 0; i3 < 2; i3++)
     y_[i] = y[i];
     z_[i] = z[i];
   }  
-
 }
 
-
 }
 
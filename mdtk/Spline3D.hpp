@@ -34,15 +34,14 @@ namespace mdtk
 class Spline3D
 {
 private:
-  SplineMultiD f;
-  SplineMultiD dfdx;
-  SplineMultiD dfdy;
-  SplineMultiD dfdz;
+  Float  c_[4][4][4];
   Float  x_[2];
   Float  y_[2];
   Float  z_[2];
 public:
   Float operator()(Float x, Float y, Float z) const;
+  Float operator()(Float x, Float y, Float z,
+                   Float& dfdx, Float& dfdy, Float& dfdz) const;
   Float dx(Float x, Float y, Float z) const;
   Float dy(Float x, Float y, Float z) const;
   Float dz(Float x, Float y, Float z) const;
@@ -65,18 +64,16 @@ public:
          Float dvdy[2][2][2],
          Float dvdz[2][2][2]
          )
-   : f(3), dfdx(3), dfdy(3), dfdz(3) {init(x,y,z,v,dvdx,dvdy,dvdz);}
+   {init(x,y,z,v,dvdx,dvdy,dvdz);}
 
-  Spline3D() : f(3), dfdx(3), dfdy(3), dfdz(3){};
+  Spline3D() {};
   virtual ~Spline3D() {}
 
   void SaveToStream(std::ostream& os, YAATK_FSTREAM_MODE smode)
   {
     int i;
-    f.SaveToStream(os,smode);
-    dfdx.SaveToStream(os,smode);
-    dfdy.SaveToStream(os,smode);
-    dfdz.SaveToStream(os,smode);
+    for(i = 0;i < 64;i++)
+      YAATK_FSTREAM_WRITE(os,c_[i/16][i/4%4][i%4],smode);
 
     for(i = 0;i < 2;i++)
       YAATK_FSTREAM_WRITE(os,x_[i],smode);
@@ -88,10 +85,8 @@ public:
   void LoadFromStream(std::istream& is, YAATK_FSTREAM_MODE smode)
   {
     int i;
-    f.LoadFromStream(is,smode);
-    dfdx.LoadFromStream(is,smode);
-    dfdy.LoadFromStream(is,smode);
-    dfdz.LoadFromStream(is,smode);
+    for(i = 0;i < 64;i++)
+      YAATK_FSTREAM_READ(is,c_[i/16][i/4%4][i%4],smode);
 
     for(i = 0;i < 2;i++)
       YAATK_FSTREAM_READ(is,x_[i],smode);
@@ -106,44 +101,103 @@ inline
 Float
 Spline3D::operator()(Float x, Float y, Float z) const
 {
-  std::vector<Float> xv(3);
-  xv[0] = x;
-  xv[1] = y;
-  xv[2] = z;
-  return f(xv);
+  x -= x_[0];
+  y -= y_[0];
+  z -= z_[0];
+  Float p[4];
+  for(int i = 0; i < 4; i++)
+  {
+    Float q[4];
+    for(int j = 0; j < 4; j++)
+      q[j] = cubicValue(c_[i][j],z);
+    p[i] = cubicValue(q,y);
+  }
+  return cubicValue(p,x);
+}
+
+// the value and all three derivatives at once
+inline
+Float
+Spline3D::operator()(Float x, Float y, Float z,
+                     Float& dfdx, Float& dfdy, Float& dfdz) const
+{
+  x -= x_[0];
+  y -= y_[0];
+  z -= z_[0];
+  Float p[4];
+  Float py[4];
+  Float pz[4];
+  for(int i = 0; i < 4; i++)
+  {
+    Float q[4];
+    Float qz[4];
+    for(int j = 0; j < 4; j++)
+    {
+      q[j] = cubicValue(c_[i][j],z);
+      qz[j] = cubicDerivative(c_[i][j],z);
+    }
+    p[i] = cubicValue(q,y);
+    py[i] = cubicDerivative(q,y);
+    pz[i] = cubicValue(qz,y);
+  }
+  dfdx = cubicDerivative(p,x);
+  dfdy = cubicValue(py,x);
+  dfdz = cubicValue(pz,x);
+  return cubicValue(p,x);
 }
 
 inline
 Float
 Spline3D::dx(Float x, Float y, Float z) const
 {
-  std::vector<Float> xv(3);
-  xv[0] = x;
-  xv[1] = y;
-  xv[2] = z;
-  return dfdx(xv);
+  x -= x_[0];
+  y -= y_[0];
+  z -= z_[0];
+  Float p[4];
+  for(int i = 0; i < 4; i++)
+  {
+    Float q[4];
+    for(int j = 0; j < 4; j++)
+      q[j] = cubicValue(c_[i][j],z);
+    p[i] = cubicValue(q,y);
+  }
+  return cubicDerivative(p,x);
 }
 
 inline
 Float
 Spline3D::dy(Float x, Float y, Float z) const
 {
-  std::vector<Float> xv(3);
-  xv[0] = x;
-  xv[1] = y;
-  xv[2] = z;
-  return dfdy(xv);
+  x -= x_[0];
+  y -= y_[0];
+  z -= z_[0];
+  Float p[4];
+  for(int i = 0; i < 4; i++)
+  {
+    Float q[4];
+    for(int j = 0; j < 4; j++)
+      q[j] = cubicValue(c_[i][j],z);
+    p[i] = cubicDerivative(q,y);
+  }
+  return cubicValue(p,x);
 }
 
 inline
 Float
 Spline3D::dz(Float x, Float y, Float z) const
 {
-  std::vector<Float> xv(3);
-  xv[0] = x;
-  xv[1] = y;
-  xv[2] = z;
-  return dfdz(xv);
+  x -= x_[0];
+  y -= y_[0];
+  z -= z_[0];
+  Float p[4];
+  for(int i = 0; i < 4; i++)
+  {
+    Float q[4];
+    for(int j = 0; j < 4; j++)
+      q[j] = cubicDerivative(c_[i][j],z);
+    p[i] = cubicValue(q,y);
+  }
+  return cubicValue(p,x);
 }
 
 
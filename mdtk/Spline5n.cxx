@@ -31,6 +31,10 @@ using std::sqrt;
 using std::pow;
 
 
+/*
+  The quintic Hermite interpolant: value, slope and curvature given at
+  both ends of [x0,x0+h], in the powers of s = x - x0.
+*/
 void
 Spline5n::init(
          Float       x[2],
@@ -39,71 +43,42 @@ Spline5n::init(
          Float    d2vdxdx[2]
 )
 {
-  size_t N = 1;
-
-  SplineMultiD Fv(N,5);
-
-  SplineMultiD Fdvdx(N,5);
-
-  Fdvdx.differentiate(0);
-
-  SplineMultiD Fd2vdxdx(N,5);
-
-  Fd2vdxdx.differentiate(0); Fd2vdxdx.differentiate(0);
-
-/*
-  f.bounds[0][0] = x[0];
-  f.bounds[0][1] = x[1];
-  f.bounds[1][0] = y[0];
-  f.bounds[1][1] = y[1];
-  f.bounds[2][0] = z[0];
-  f.bounds[2][1] = z[1];
-*/
-
-std::vector<std::vector<Float> > xvs; std::vector<Float> fvs;
-
-  std::vector<Float> xv;
-  xv.resize(N);
- 
-  Float fv;
-
-#define FILL(VFUN,i1) \
-{ \
-  xv[0] = x[i1]; \
-  fv = VFUN[i1]; \
-  addEquation(F##VFUN,xv,fv,xvs,fvs); \
-}
-
-for(size_t i1 = 0; i1 < 2; i1++)
-  FILL(v,i1);
-
-for(size_t i1 = 0; i1 < 2; i1++)
-  FILL(dvdx,i1);
-
-for(size_t i1 = 0; i1 < 2; i1++)
-  FILL(d2vdxdx,i1);
-
-#define FILL0(VFUN,i1) \
-{ \
-  xv[0] = x[i1]; \
-  fv = 0.0; \
-  addEquation(F##VFUN,xv,fv,xvs,fvs); \
-}
-
-  f.addEquations(xvs,fvs);
-
-
-  dfdx = f;
-
-  dfdx.differentiate(0);
+  static const Float basis[6][6] =
+  {
+    { 1.0, 0.0, 0.0, -10.0,  15.0,  -6.0},
+    { 0.0, 0.0, 0.0,  10.0, -15.0,   6.0},
+    { 0.0, 1.0, 0.0,  -6.0,   8.0,  -3.0},
+    { 0.0, 0.0, 0.0,  -4.0,   7.0,  -3.0},
+    { 0.0, 0.0, 0.5,  -1.5,   1.5,  -0.5},
+    { 0.0, 0.0, 0.0,   0.5,  -1.0,   0.5}
+  };
+
+  Float h = x[1]-x[0];
+  REQUIRE(h != 0.0);
+
+  Float w[6];
+  w[0] = v[0];
+  w[1] = v[1];
+  w[2] = dvdx[0]*h;
+  w[3] = dvdx[1]*h;
+  w[4] = d2vdxdx[0]*h*h;
+  w[5] = d2vdxdx[1]*h*h;
+
+  Float hk = 1.0;
+  for(int k = 0; k < 6; k++)
+  {
+    Float c = 0.0;
+    for(int m = 0; m < 6; m++)
+      c += w[m]*basis[m][k];
+    c_[k] = c/hk;
+    hk *= h;
+  }
 
   for(int i = 0;i < 2;i++)
   {
     x_[i] = x[i];
   }  
-
 }
 
-
 }
 
@@ -34,11 +34,11 @@ namespace mdtk
 class Spline5n
 {
 private:
-  SplineMultiD f;
-  SplineMultiD dfdx;
+  Float  c_[6];
   Float  x_[2];
 public:
   Float operator()(Float x) const;
+  Float operator()(Float x, Float& dfdx) const;
   void init(
          Float       x[2],
          Float       v[2],
@@ -51,12 +51,12 @@ public:
          Float       v[2],
          Float    dvdx[2],
          Float    d2vdxdx[2]
-  ):f(1,5), dfdx(1,5)
+  )
   {
     init(x,v,dvdx,d2vdxdx);
   }
-  Spline5n(Float x1 = 0.0, Float y1 = 1.0, Float dy1 = 0.0, Float d2y1 = 0.0,           Float x2 = 1.0, Float y2 = 1.0, Float dy2 = 0.0, Float d2y2 = 0.0)
-  :f(1,5), dfdx(1,5)
+  Spline5n(Float x1 = 0.0, Float y1 = 1.0, Float dy1 = 0.0, Float d2y1 = 0.0,
+           Float x2 = 1.0, Float y2 = 1.0, Float dy2 = 0.0, Float d2y2 = 0.0)
   {
     Float       x[2];
     Float       v[2];
@@ -81,16 +81,16 @@ public:
 
   void SaveToStream(std::ostream& os, YAATK_FSTREAM_MODE smode)
   {
-    f.SaveToStream(os,smode);
-    dfdx.SaveToStream(os,smode);
+    for(int i = 0;i < 6;i++)
+      YAATK_FSTREAM_WRITE(os,c_[i],smode);
 
     YAATK_FSTREAM_WRITE(os,x_[0],smode);
     YAATK_FSTREAM_WRITE(os,x_[1],smode);
   }  
   void LoadFromStream(std::istream& is, YAATK_FSTREAM_MODE smode)
   {
-    f.LoadFromStream(is,smode);
-    dfdx.LoadFromStream(is,smode);
+    for(int i = 0;i < 6;i++)
+      YAATK_FSTREAM_READ(is,c_[i],smode);
 
     YAATK_FSTREAM_READ(is,x_[0],smode);
     YAATK_FSTREAM_READ(is,x_[1],smode);
@@ -101,18 +101,26 @@ inline
 Float
 Spline5n::operator()(Float x) const
 {
-  std::vector<Float> xv(1);
-  xv[0] = x;
-  return f(xv);
+  x -= x_[0];
+  return c_[0]+x*(c_[1]+x*(c_[2]+x*(c_[3]+x*(c_[4]+x*c_[5]))));
+}
+
+// the value and the derivative at once
+inline
+Float
+Spline5n::operator()(Float x, Float& dfdx) const
+{
+  x -= x_[0];
+  dfdx = c_[1]+x*(2.0*c_[2]+x*(3.0*c_[3]+x*(4.0*c_[4]+x*5.0*c_[5])));
+  return c_[0]+x*(c_[1]+x*(c_[2]+x*(c_[3]+x*(c_[4]+x*c_[5]))));
 }
 
 inline
 Float
 Spline5n::der(Float x) const
 {
-  std::vector<Float> xv(1);
-  xv[0] = x;
-  return dfdx(xv);
+  x -= x_[0];
+  return c_[1]+x*(2.0*c_[2]+x*(3.0*c_[3]+x*(4.0*c_[4]+x*5.0*c_[5])));
 }
 
 
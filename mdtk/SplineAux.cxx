@@ -60,6 +60,19 @@ addEquation(SplineMultiD& s, std::vector<Float>& xv, Float& fv,
   fvs[fvs.size()-1] = fv;
 }
 
+void
+cubicHermiteBasis(Float h, Float basis[4][4])
+{
+  REQUIRE(h != 0.0);
+  Float h2 = h*h;
+  Float h3 = h2*h;
+
+  basis[0][0] = 1.0;  basis[0][1] = 0.0;  basis[0][2] = -3.0/h2; basis[0][3] =  2.0/h3;
+  basis[1][0] = 0.0;  basis[1][1] = 0.0;  basis[1][2] =  3.0/h2; basis[1][3] = -2.0/h3;
+  basis[2][0] = 0.0;  basis[2][1] = 1.0;  basis[2][2] = -2.0/h;  basis[2][3] =  1.0/h2;
+  basis[3][0] = 0.0;  basis[3][1] = 0.0;  basis[3][2] = -1.0/h;  basis[3][3] =  1.0/h2;
+}
+
 void
 SplineMultiD::addEquations(std::vector<std::vector<Float> >& xvs, std::vector<Float>& fvs)
 {
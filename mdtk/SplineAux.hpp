@@ -170,6 +170,33 @@ void
 addEquation(SplineMultiD& s, std::vector<Float>& xv, Float& fv,
    std::vector<std::vector<Float> >& xvs, std::vector<Float>& fvs);
 
+/*
+  Spline, Spline2D, Spline3D and Spline5n are Hermite interpolants on a
+  single cell, so their coefficients are written down directly instead
+  of being fitted. They are kept in the powers of the offset from the
+  lower corner of the cell, s = x - x0, and evaluated by Horner's scheme.
+
+  Rows of the cubic Hermite basis on [x0,x0+h] in the powers of s: the
+  functions that are 1 at x0 and at x0+h, then those with unit slope
+  there.
+*/
+void
+cubicHermiteBasis(Float h, Float basis[4][4]);
+
+inline
+Float
+cubicValue(const Float c[4], Float x)
+{
+  return c[0]+x*(c[1]+x*(c[2]+x*c[3]));
+}
+
+inline
+Float
+cubicDerivative(const Float c[4], Float x)
+{
+  return c[1]+x*(2.0*c[2]+x*3.0*c[3]);
+}
+
 inline
 SplineMultiD::~SplineMultiD()
 {
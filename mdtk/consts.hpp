@@ -78,6 +78,31 @@ ElementIDtoString(ElementID id)
   return str;
 }
 
+/*
+  Dense index of the element. It is assigned to every atom before the
+  simulation, so that the potentials can keep their per-element tables
+  small and flat; 0 stands for the elements none of them knows.
+*/
+#define SPECIES_size 9
+
+inline
+unsigned char
+ElementIDtoSpecies(ElementID id)
+{
+  switch (id)
+  {
+  case H_EL  : return 1;
+  case C_EL  : return 2;
+  case Cu_EL : return 3;
+  case Ag_EL : return 4;
+  case Au_EL : return 5;
+  case Ar_EL : return 6;
+  case Xe_EL : return 7;
+  case DUMMY_EL : return 8;
+  default : return 0;
+  }
+}
+
 inline
 ElementID
 StringToElementID(std::string s)
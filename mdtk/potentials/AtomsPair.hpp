@@ -26,12 +26,26 @@
 #include <mdtk/config.hpp>
 #include <mdtk/consts.hpp>
 #include <mdtk/Atom.hpp>
+#include <mdtk/potentials/ForceThreads.hpp>
 
 #include <cmath>
 
 namespace mdtk
 {
 
+/*
+  Separation and cutoff function of a pair as computed by AtomsPair, for
+  the bond tables the manybody potentials fill once per evaluation.
+*/
+struct PairGeometry
+{
+  Vector3D rv;
+  Float r;
+  Vector3D unit;
+  Float f;
+  Float df;
+};
+
 struct AtomsPair
 {
   Atom& atom1;
@@ -45,8 +59,8 @@ public:
     {
       if (V != 0.0)
       {
-        atom1.grad += dr(atom1)*V;
-        atom2.grad += dr(atom2)*V;
+        gradient(atom1) += dr(atom1)*V;
+        gradient(atom2) += dr(atom2)*V;
       }
       return r_;
     }
@@ -56,8 +70,8 @@ public:
         return r(V);
       if (V != 0.0)
       {
-        atom1.grad += dr_alter(atom1)*V;
-        atom2.grad += dr_alter(atom2)*V;
+        gradient(atom1) += dr_alter(atom1)*V;
+        gradient(atom2) += dr_alter(atom2)*V;
       }
       return r_alter_;
     }
@@ -134,6 +148,32 @@ public:
         alter_depos_enabled = false;
       }
     }
+  PairGeometry geometry() const
+    {
+      PairGeometry g;
+      g.rv = rv;
+      g.r = r_;
+      g.unit = dr_vec_module_template;
+      g.f = f_;
+      g.df = df_template;
+      return g;
+    }
+/*
+  The pair (ai,aj) from the geometry of (ai,aj), or of (aj,ai) if
+  reversed.
+*/
+  AtomsPair(Atom& ai, Atom& aj, const PairGeometry& g, const bool reversed = false)
+    :atom1(ai),atom2(aj),
+     rv(reversed?-g.rv:g.rv),
+     r_(g.r),
+     r_squared_(r_*r_),
+     dr_vec_module_template(reversed?-g.unit:g.unit),
+     f_(g.f),
+     df_template(g.df),
+     r_alter_(0.0),
+     alter_depos_enabled(false)
+    {
+    }
   AtomsPair(Atom& ai, Atom& aj, const Float R1, const Float R2, const Float alter_depos = 0.0)
     :atom1(ai),atom2(aj),
      rv(depos(ai,aj)),
@@ -29,8 +29,11 @@ namespace mdtk
 FGeneral::FGeneral():
   handledElements(),
   handledElementPairs(),
+  handledSpecies(0),
   nl(this)
 {
+  for(size_t s = 0; s < SPECIES_size; s++)
+    handledSpeciesPairs[s] = 0;
 }
 
 }
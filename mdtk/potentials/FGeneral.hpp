@@ -58,14 +58,24 @@ public:
 
   std::set<ElementID> handledElements;
   std::set<std::pair<ElementID,ElementID> > handledElementPairs;
+  void handleElement(ElementID id);
+  void handleElementPair(ElementID id1, ElementID id2);
   bool isHandled(const Atom& atom) const;
   bool isHandledPair(const Atom& atom1, const Atom& atom2) const;
+private:
+/*
+  The sets above as bitmasks over the atom species, for the force loops:
+  bit s of handledSpecies is set when the species s is handled, bit s of
+  handledSpeciesPairs[s1] when the pair (s1,s) is.
+*/
+  unsigned int handledSpecies;
+  unsigned int handledSpeciesPairs[SPECIES_size];
 protected:
 public:
   NeighbourList nl;
-  AtomRefsContainer& NL(const Atom& atom)
+  NeighbourRefs NL(const Atom& atom)
   {
-    return nl.nl[atom.globalIndex];
+    return nl.neighbours(atom.globalIndex);
   }
 
   virtual
@@ -87,7 +97,7 @@ public:
   virtual
   void incDisplacement(Atom& atom, Vector3D inc)
   {
-    nl.displacements[atom.globalIndex] += inc;
+    nl.incDisplacement(atom.globalIndex,inc);
   }
 
   FGeneral();
@@ -113,24 +123,36 @@ public:
   }
 };
 
+inline
+void
+FGeneral::handleElement(ElementID id)
+{
+  REQUIRE(ElementIDtoSpecies(id) != 0);
+  handledElements.insert(id);
+  handledSpecies |= 1u << ElementIDtoSpecies(id);
+}
+
+inline
+void
+FGeneral::handleElementPair(ElementID id1, ElementID id2)
+{
+  REQUIRE(ElementIDtoSpecies(id1) != 0 && ElementIDtoSpecies(id2) != 0);
+  handledElementPairs.insert(std::make_pair(id1,id2));
+  handledSpeciesPairs[ElementIDtoSpecies(id1)] |= 1u << ElementIDtoSpecies(id2);
+}
+
 inline
 bool
 FGeneral::isHandled(const Atom& atom) const
 {
-  if (handledElements.find(atom.ID) != handledElements.end())
-    return true;
-  else
-    return false;
+  return (handledSpecies >> atom.species) & 1u;
 }
 
 inline
 bool
 FGeneral::isHandledPair(const Atom& atom1, const Atom& atom2) const
 {
-  if (handledElementPairs.find(std::make_pair(atom1.ID,atom2.ID)) != handledElementPairs.end() )
-    return true;
-  else
-    return false;
+  return (handledSpeciesPairs[atom1.species] >> atom2.species) & 1u;
 }
 
 #define CosT_epsilon 1e-7
@@ -157,7 +179,7 @@ FGeneral::CosTheta(AtomsPair& ij, AtomsPair& ik, const Float V)
 
       Vector3D dCosTheta = (de1*e2-e1*de2)/SQR(e2);
 
-      ij.atom1.grad += dCosTheta*V;
+      gradient(ij.atom1) += dCosTheta*V;
     }
     {
       Vector3D de1 = -ik.rv;
@@ -165,7 +187,7 @@ FGeneral::CosTheta(AtomsPair& ij, AtomsPair& ik, const Float V)
 
       Vector3D dCosTheta = (de1*e2-e1*de2)/SQR(e2);
 
-      ij.atom2.grad += dCosTheta*V;
+      gradient(ij.atom2) += dCosTheta*V;
     }
     {
       Vector3D de1 = -ij.rv;
@@ -173,7 +195,7 @@ FGeneral::CosTheta(AtomsPair& ij, AtomsPair& ik, const Float V)
 
       Vector3D dCosTheta = (de1*e2-e1*de2)/SQR(e2);
 
-      ik.atom2.grad += dCosTheta*V;
+      gradient(ik.atom2) += dCosTheta*V;
     }
   }
 
@@ -249,7 +271,7 @@ FGeneral::CosDihedral(AtomsPair& ij, AtomsPair& ik, AtomsPair& jl, const Float V
       de2.z = e2_2_e2_1*dejik_module_squared_dz_ + e2_1_e2_2*deijl_module_squared_dz_;
       dCosDihedral = (de1*e2-e1*de2)/SQR(e2);
 
-      ij.atom1.grad += dCosDihedral*V;
+      gradient(ij.atom1) += dCosDihedral*V;
     }
     {
       de1.x = -ik.rv.z*eijl.y+ejik.y*il.rv.z+ik.rv.y*eijl.z-ejik.z*il.rv.y;
@@ -267,7 +289,7 @@ FGeneral::CosDihedral(AtomsPair& ij, AtomsPair& ik, AtomsPair& jl, const Float V
       de2.z = e2_2_e2_1*dejik_module_squared_dz_ + e2_1_e2_2*deijl_module_squared_dz_;
       dCosDihedral = (de1*e2-e1*de2)/SQR(e2);
 
-      ij.atom2.grad += dCosDihedral*V;
+      gradient(ij.atom2) += dCosDihedral*V;
     }
     {
       de1.x =  ij.rv.z*eijl.y-ij.rv.y*eijl.z;
@@ -282,7 +304,7 @@ FGeneral::CosDihedral(AtomsPair& ij, AtomsPair& ik, AtomsPair& jl, const Float V
       de2.z = e2_2_e2_1*dejik_module_squared_dz_;
       dCosDihedral = (de1*e2-e1*de2)/SQR(e2);
 
-      ik.atom2.grad += dCosDihedral*V;
+      gradient(ik.atom2) += dCosDihedral*V;
     }
     {
       de1.x = -ejik.y*ij.rv.z+ejik.z*ij.rv.y;
@@ -297,7 +319,7 @@ FGeneral::CosDihedral(AtomsPair& ij, AtomsPair& ik, AtomsPair& jl, const Float V
       de2.z = e2_1_e2_2*deijl_module_squared_dz_;
       dCosDihedral = (de1*e2-e1*de2)/SQR(e2);
 
-      jl.atom2.grad += dCosDihedral*V;
+      gradient(jl.atom2) += dCosDihedral*V;
     }
   }
 
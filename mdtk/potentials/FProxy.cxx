@@ -27,7 +27,12 @@ namespace mdtk
 {
 
 FProxy::FProxy()
- :potentials()
+ :potentials(),
+  nl(NULL),
+  nlSkinTuner(),
+  nlSkins(),
+  atomsReorderInterval(0),
+  fullRebuildCount(0)
 {
 }
 
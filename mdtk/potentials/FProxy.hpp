@@ -54,12 +54,32 @@ public:
 
   void incDisplacement(Atom& atom, Vector3D inc)
   {
-    for(size_t i = 0; i < potentials.size(); i++)
-      potentials[i]->incDisplacement(atom,inc);
+    nl.displacements[atom.globalIndex] += inc;
   }  
 
+  void NL_applySkins()
+  {
+    std::vector<NeighbourList*> views;
+    for(size_t i = 0; i < potentials.size(); i++)
+    {
+      potentials[i]->nl.skin = nlSkins[i]*nlSkinTuner.scale;
+// a potential walking the list of another one keeps a zero range
+      if (potentials[i]->nl.Rcutoff > 0.0)
+        views.push_back(&potentials[i]->nl);
+    }
+    nl.attachViews(views);
+  }
+
   void NL_init(AtomsArray& atoms)
   {
+    if (nlSkins.size() != potentials.size())
+    {
+      nlSkins.clear();
+      for(size_t i = 0; i < potentials.size(); i++)
+        nlSkins.push_back(potentials[i]->nl.skin);
+    }
+    NL_applySkins();
+    nl.init(atoms);
     for(size_t i = 0; i < potentials.size(); i++)
     {
       potentials[i]->NL_init(atoms);
@@ -68,22 +88,58 @@ public:
 
   void NL_checkRequestUpdate(AtomsArray& atoms)
   {
+    if (potentials.size() == 0) return;
+    nl.checkRequestUpdate(atoms);
+    if (nl.incremental) return;
     for(size_t i = 0; i < potentials.size(); i++)
       potentials[i]->NL_checkRequestUpdate(atoms);
   }
-  void NL_UpdateIfNeeded(AtomsArray& atoms)
+  void NL_UpdateIfNeeded(AtomsArray& atoms, bool reorderAllowed = false)
   {
-    std::vector<NeighbourList*> nlObjectsToUpdate;
+    if (potentials.size() == 0) return;
+    bool masterUpdateRequested = nl.ListUpdateRequested;
+    bool viewUpdateRequested = false;
+    for(size_t i = 0; i < potentials.size(); i++)
+    {
+      NeighbourList& nlObject = potentials[i]->nl;
+      if (nlObject.ListUpdateRequested)
+      {
+        viewUpdateRequested = true;
+        if (!nlObject.coveredByMaster())
+          masterUpdateRequested = true;
+      }
+    }
+    if (nl.incremental && !viewUpdateRequested)
+    {
+      if (masterUpdateRequested)
+      {
+        nl.UpdateIncremental(atoms);
+        nl.ListUpdateRequested = false;
+      }
+      return;
+    }
+    if (masterUpdateRequested)
+    {
+      if (nlSkinTuner.enabled && nlSkinTuner.rebuildStarts())
+        NL_applySkins();
+      if (reorderAllowed && atomsReorderInterval > 0 &&
+          fullRebuildCount++ % atomsReorderInterval == 0)
+        atoms.reorderByMortonKey(nl.Rcutoff+nl.skin);
+      std::vector<NeighbourList*> nlObjectsToUpdate;
+      nlObjectsToUpdate.push_back(&nl);
+      NeighbourList::Update(atoms,nlObjectsToUpdate);
+      nl.ListUpdateRequested = false;
+      return;
+    }
     for(size_t i = 0; i < potentials.size(); i++)
     {
       NeighbourList& nlObject = potentials[i]->nl;
       if (nlObject.ListUpdateRequested)
       {
-        nlObjectsToUpdate.push_back(&nlObject);
+        nlObject.UpdateFromMaster(atoms);
         nlObject.ListUpdateRequested = false;
       }
     }
-    NeighbourList::Update(atoms,nlObjectsToUpdate);
   }
 
   void SaveToStream(std::ostream& os, YAATK_FSTREAM_MODE smode)
@@ -99,14 +155,19 @@ public:
   bool hasNeighbors(Atom& atom)
   {
     for(size_t i = 0; i < potentials.size(); i++)
-      if (potentials[i]->NL(atom).size() > 0) return true;
+      if (potentials[i]->nl.hasNeighbours(atom.globalIndex)) return true;
     return false;
   }  
-  
-  struct fakeNL
-  {
-    Float nlSkin() {TRACE("***CAUTION*** Called fake nlSkin()");return 0.0;}
-  }nl;  
+
+  NeighbourList nl;
+  NeighbourSkinTuner nlSkinTuner;
+  std::vector<Float> nlSkins;
+/*
+  If nonzero, every atomsReorderInterval-th full rebuild of the lists
+  starts with sorting the atoms by their Morton keys.
+*/
+  size_t atomsReorderInterval;
+  size_t fullRebuildCount;
 
   void diagnose();
 };
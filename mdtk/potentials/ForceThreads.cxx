@@ -0,0 +1,46 @@
+/*
+   Threaded evaluation of the interatomic potentials.
+
+   Copyright (C) 2012 Oleksandr Yermolenko
+   <oleksandr.yermolenko@gmail.com>
+
+   This file is part of MDTK, the Molecular Dynamics Toolkit.
+
+   MDTK is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   MDTK is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with MDTK.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <mdtk/potentials/ForceThreads.hpp>
+
+namespace mdtk
+{
+
+Vector3D* threadGradients = NULL;
+
+/*
+  Number of threads evaluating the forces, set by OMP_NUM_THREADS;
+  always 1 without OpenMP.
+*/
+int
+forceThreads()
+{
+#ifdef MDTK_OPENMP
+  if (omp_in_parallel())
+    return 1;
+  return omp_get_max_threads();
+#else
+  return 1;
+#endif
+}
+
+}
@@ -0,0 +1,137 @@
+/*
+   Threaded evaluation of the interatomic potentials (header file).
+
+   Copyright (C) 2012 Oleksandr Yermolenko
+   <oleksandr.yermolenko@gmail.com>
+
+   This file is part of MDTK, the Molecular Dynamics Toolkit.
+
+   MDTK is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   MDTK is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with MDTK.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef mdtk_ForceThreads_hpp
+#define mdtk_ForceThreads_hpp
+
+#include <vector>
+#include <string>
+#include <mdtk/config.hpp>
+#include <mdtk/Atom.hpp>
+#include <mdtk/AtomsContainer.hpp>
+
+#ifdef MDTK_OPENMP
+#include <omp.h>
+#endif
+
+#define FORCE_THREADS_CHUNK 16
+
+namespace mdtk
+{
+
+/*
+  While a potential is evaluated by several threads, each thread adds
+  its gradients to a buffer of its own, indexed by globalIndex; NULL
+  outside of the threaded evaluation.
+*/
+extern Vector3D* threadGradients;
+#ifdef MDTK_OPENMP
+#pragma omp threadprivate(threadGradients)
+#endif
+
+inline
+Vector3D&
+gradient(Atom& atom)
+{
+#ifdef MDTK_OPENMP
+  if (threadGradients)
+    return threadGradients[atom.globalIndex];
+#endif
+  return atom.grad;
+}
+
+int forceThreads();
+
+// number of the calling thread among those evaluating the forces
+inline
+int
+forceThread()
+{
+#ifdef MDTK_OPENMP
+  return omp_get_thread_num();
+#else
+  return 0;
+#endif
+}
+
+/*
+  Calls (pot.*accumulate)(gl,i,Ei) for every atom i. With several threads
+  the atoms are dealt out in fixed chunks, and the energies and gradients
+  of the threads are summed in thread order afterwards, so the result
+  does not depend on the scheduling.
+*/
+template <class Potential>
+Float
+accumulateOverAtoms(Potential& pot, AtomsArray& gl,
+                    void (Potential::*accumulate)(AtomsArray&, size_t, Float&))
+{
+  Float Ei = 0;
+  int threads = forceThreads();
+  if (threads == 1)
+  {
+    for(size_t i = 0; i < gl.size(); i++)
+      (pot.*accumulate)(gl,i,Ei);
+    return Ei;
+  }
+#ifdef MDTK_OPENMP
+  int N = gl.size();
+  std::vector<std::vector<Vector3D> > grads(threads);
+  std::vector<Float> energies(threads,0.0);
+  std::string failure;
+#pragma omp parallel num_threads(threads)
+  {
+    int t = omp_get_thread_num();
+    grads[t].assign(N+1,Vector3D(0.0,0.0,0.0));
+    threadGradients = &grads[t][0];
+    Float E = 0;
+#pragma omp for schedule(static,FORCE_THREADS_CHUNK)
+    for(int i = 0; i < N; i++)
+    {
+      try
+      {
+        (pot.*accumulate)(gl,i,E);
+      }
+      catch (Exception& e)
+      {
+#pragma omp critical(mdtk_ForceThreads_failure)
+        failure = e.what();
+      }
+    }
+    energies[t] = E;
+    threadGradients = NULL;
+  }
+  if (!failure.empty())
+    throw Exception(failure);
+
+  for(int t = 0; t < threads; t++)
+    Ei += energies[t];
+#pragma omp parallel for num_threads(threads) schedule(static)
+  for(int i = 0; i < N; i++)
+    for(int t = 0; t < threads; t++)
+      gl[i].grad += grads[t][i];
+#endif
+  return Ei;
+}
+
+}
+
+#endif
@@ -22,11 +22,265 @@
 
 #include <mdtk/potentials/NeighbourList.hpp>
 #include <mdtk/potentials/FGeneral.hpp>
+#include <mdtk/potentials/ForceThreads.hpp>
+#include <algorithm>
 
 namespace mdtk
 {
 
-#define NLSKIN_FACTOR 0.44
+#define NLCELLS_PER_ATOM_MAX 2
+#define NLBUILD_BLOCKS_PER_THREAD 8
+
+/*
+  Define to check at every step of the incremental mode that the list
+  holds all the pairs within the cutoff, against a search from scratch.
+*/
+//#define NLINCREMENTAL_CHECK
+
+/*
+  Linked-cell binning of a set of atoms. Atoms are binned by the
+  coordinates that depos() actually subtracts for the given pair of
+  PBC settings, so the cell stencil never misses a pair depos() would
+  accept. Dimensions shared by both PBC settings are wrapped, the others
+  are binned over the bounding box of the atoms.
+*/
+class NeighbourCells
+{
+public:
+  int n[3];
+  bool periodic[3];
+  Float lo[3];
+  Float size[3];
+  std::vector<int> head;
+  std::vector<int> next;
+
+  static Float effectiveCoord(const Atom& a, const Vector3D& otherPBC, int d)
+  {
+    if (a.PBC.X(d) != NO_PBC.X(d) && otherPBC.X(d) == NO_PBC.X(d))
+      return a.coords.X(d) + a.PBC.X(d)*a.PBC_count.X(d);
+    return a.coords.X(d);
+  }
+
+  NeighbourCells(const AtomsArray& atoms,
+                 const std::vector<size_t>& set1, const Vector3D& pbc1,
+                 const std::vector<size_t>& set2, const Vector3D& pbc2,
+                 Float range);
+
+  int cellIndex(const Atom& a, const Vector3D& otherPBC, int c[3]) const
+  {
+    for(int d = 0; d < 3; d++)
+    {
+      Float x = effectiveCoord(a,otherPBC,d) - lo[d];
+      if (periodic[d])
+        x -= floor(x/(n[d]*size[d]))*(n[d]*size[d]);
+      int cd = int(floor(x/size[d]));
+      if (cd < 0) cd = 0;
+      if (cd >= n[d]) cd = n[d]-1;
+      c[d] = cd;
+    }
+    return (c[2]*n[1]+c[1])*n[0]+c[0];
+  }
+
+  void stencil(int d, int c, std::vector<int>& cs) const
+  {
+    cs.clear();
+    if (periodic[d] && n[d] < 3)
+    {
+      for(int k = 0; k < n[d]; k++)
+        cs.push_back(k);
+      return;
+    }
+    for(int o = -1; o <= 1; o++)
+    {
+      int k = c+o;
+      if (periodic[d])
+        k = (k+n[d])%n[d];
+      else
+        if (k < 0 || k >= n[d]) continue;
+      cs.push_back(k);
+    }
+  }
+};
+
+NeighbourCells::NeighbourCells(const AtomsArray& atoms,
+                               const std::vector<size_t>& set1, const Vector3D& pbc1,
+                               const std::vector<size_t>& set2, const Vector3D& pbc2,
+                               Float range)
+  : head(), next()
+{
+  REQUIRE(range > 0.0);
+  for(int d = 0; d < 3; d++)
+  {
+    periodic[d] = (pbc1.X(d) == pbc2.X(d) && pbc1.X(d) != NO_PBC.X(d));
+    if (periodic[d])
+    {
+      lo[d] = 0.0;
+      n[d] = int(pbc1.X(d)/range);
+      if (n[d] < 1) n[d] = 1;
+      continue;
+    }
+    Float hi = 0.0;
+    lo[d] = 0.0;
+    bool first = true;
+    for(size_t k = 0; k < set1.size()+set2.size(); k++)
+    {
+      Float x = (k < set1.size())
+        ?effectiveCoord(atoms[set1[k]],pbc2,d)
+        :effectiveCoord(atoms[set2[k-set1.size()]],pbc1,d);
+      if (first || x < lo[d]) lo[d] = x;
+      if (first || x > hi) hi = x;
+      first = false;
+    }
+    n[d] = int((hi-lo[d])/range)+1;
+  }
+
+  size_t cellsMax = NLCELLS_PER_ATOM_MAX*set2.size()+27;
+  while (size_t(n[0])*n[1]*n[2] > cellsMax)
+  {
+    int dmax = 0;
+    for(int d = 1; d < 3; d++)
+      if (n[d] > n[dmax]) dmax = d;
+    n[dmax] = (n[dmax]+1)/2;
+  }
+
+  for(int d = 0; d < 3; d++)
+  {
+    if (periodic[d])
+      size[d] = pbc1.X(d)/n[d];
+    else
+    {
+      Float hi = lo[d];
+      for(size_t k = 0; k < set1.size()+set2.size(); k++)
+      {
+        Float x = (k < set1.size())
+          ?effectiveCoord(atoms[set1[k]],pbc2,d)
+          :effectiveCoord(atoms[set2[k-set1.size()]],pbc1,d);
+        if (x > hi) hi = x;
+      }
+      size[d] = (hi-lo[d])/n[d];
+      if (size[d] < range) size[d] = range;
+    }
+  }
+
+  std::vector<int> cellOf(set2.size());
+#ifdef MDTK_OPENMP
+#pragma omp parallel for num_threads(forceThreads()) schedule(static)
+#endif
+  for(int k = 0; k < int(set2.size()); k++)
+  {
+    int c[3];
+    cellOf[k] = cellIndex(atoms[set2[k]],pbc1,c);
+  }
+
+  head.resize(size_t(n[0])*n[1]*n[2],-1);
+  next.resize(set2.size(),-1);
+  for(size_t k = 0; k < set2.size(); k++)
+  {
+    next[k] = head[cellOf[k]];
+    head[cellOf[k]] = k;
+  }
+}
+
+/*
+  Neighbour search over all the active atoms: one set of cells for every
+  (ordered) pair of PBC groups.
+*/
+class NeighbourSearch
+{
+public:
+  std::vector<Vector3D> groupPBC;
+  std::vector<std::vector<size_t> > groupAtoms;
+  std::vector<int> groupOf;
+  std::vector<NeighbourCells> cells;
+  Float range_squared;
+
+  NeighbourSearch(const AtomsArray& atoms, const std::vector<char>& active,
+                  Float range);
+
+  const NeighbourCells& ownCells(size_t i) const
+  {
+    return cells[groupOf[i]*(groupPBC.size()+1)];
+  }
+
+  void find(AtomsArray& atoms, size_t i, size_t jmin,
+            std::vector<uint32_t>& js, std::vector<Float>& ds) const;
+};
+
+NeighbourSearch::NeighbourSearch(const AtomsArray& atoms,
+                                 const std::vector<char>& active,
+                                 Float range)
+  : groupPBC(), groupAtoms(), groupOf(atoms.size(),-1), cells(),
+    range_squared(SQR(range))
+{
+  for(size_t i = 0; i < atoms.size(); i++)
+  {
+    if (!active[i]) continue;
+
+    const Atom& atom_i = atoms[i];
+    size_t g = 0;
+    while (g < groupPBC.size() && groupPBC[g] != atom_i.PBC) g++;
+    if (g == groupPBC.size())
+    {
+      groupPBC.push_back(atom_i.PBC);
+      groupAtoms.push_back(std::vector<size_t>());
+    }
+    groupAtoms[g].push_back(i);
+    groupOf[i] = g;
+  }
+
+  size_t G = groupPBC.size();
+  for(size_t g1 = 0; g1 < G; g1++)
+  for(size_t g2 = 0; g2 < G; g2++)
+    cells.push_back(NeighbourCells(atoms,
+                                   groupAtoms[g1],groupPBC[g1],
+                                   groupAtoms[g2],groupPBC[g2],
+                                   range));
+}
+
+void
+NeighbourSearch::find(AtomsArray& atoms, size_t i, size_t jmin,
+                      std::vector<uint32_t>& js, std::vector<Float>& ds) const
+{
+  js.clear();
+  ds.clear();
+
+  if (groupOf[i] < 0) return;
+
+  Atom& atom_i = atoms[i];
+  size_t G = groupPBC.size();
+  std::vector<int> cs[3];
+
+  for(size_t g2 = 0; g2 < G; g2++)
+  {
+    const NeighbourCells& cells_ = cells[groupOf[i]*G+g2];
+    const std::vector<size_t>& set2 = groupAtoms[g2];
+
+    int c[3];
+    cells_.cellIndex(atom_i,groupPBC[g2],c);
+    for(int d = 0; d < 3; d++)
+      cells_.stencil(d,c[d],cs[d]);
+
+    for(size_t ciz = 0; ciz < cs[2].size(); ciz++)
+    for(size_t ciy = 0; ciy < cs[1].size(); ciy++)
+    for(size_t cix = 0; cix < cs[0].size(); cix++)
+    {
+      int ci = (cs[2][ciz]*cells_.n[1]+cs[1][ciy])*cells_.n[0]+cs[0][cix];
+      for(int m = cells_.head[ci]; m >= 0; m = cells_.next[m])
+      {
+        size_t j = set2[m];
+        if (j < jmin || j == i) continue;
+
+        Float dij_squared = depos(atom_i,atoms[j]).module_squared();
+
+        if (dij_squared > range_squared)
+          continue;
+
+        js.push_back(j);
+        ds.push_back(dij_squared);
+      }
+    }
+  }
+}
 
 void
 NeighbourList::Update(AtomsArray& atoms_, std::vector<NeighbourList*>& nlObjectsToUpdate)
@@ -41,28 +295,28 @@ NeighbourList::Update(AtomsArray& atoms_, std::vector<NeighbourList*>& nlObjects
 
   size_t N = atoms_.size();
 
-  for(size_t i = 0; i < N; i++)
+  for(size_t nloi = 0; nloi < nlObjectsToUpdate.size(); ++nloi)
   {
-    for(size_t nloi = 0; nloi < nlObjectsToUpdate.size(); ++nloi)
+    NeighbourList& nlObject = *(nlObjectsToUpdate[nloi]);
+    nlObject.atoms = &atoms_;
+    nlObject.displacementSum = 0.0;
+    if (nlObject.master)
+      nlObject.displacementsAtUpdate = nlObject.master->displacements;
+    else
     {
-      NeighbourList& nlObject = *(nlObjectsToUpdate[nloi]);
-
-      nlObject.displacements[i] = Vector3D(0,0,0);
-
-      AtomRefsContainer& nl_ = nlObject.nl[i];
-
-      size_t nl_size_prev = nl_.size();
-      nl_.clear();
-      nl_.reserve(nl_size_prev+MDTK_NB_RESERVE_ADD);
+      nlObject.displacements.assign(N,Vector3D(0,0,0));
+      nlObject.driftBounds.assign(N,0.0);
     }
   }
 
   Float range_squared_max = 0.0;
+  std::vector<Float> ranges_squared(nlObjectsToUpdate.size());
   for(size_t nloi = 0; nloi < nlObjectsToUpdate.size(); ++nloi)
   {
     NeighbourList& nlObject = *(nlObjectsToUpdate[nloi]);
 
-    Float range_squared = SQR((1.0+NLSKIN_FACTOR)*nlObject.Rcutoff);
+    Float range_squared = SQR(nlObject.Rcutoff+nlObject.skin);
+    ranges_squared[nloi] = range_squared;
 
     if (range_squared_max < range_squared)
       range_squared_max = range_squared;
@@ -70,46 +324,458 @@ NeighbourList::Update(AtomsArray& atoms_, std::vector<NeighbourList*>& nlObjects
   REQUIRE(range_squared_max > 0.0);
 //  TRACE(sqrt(range_squared_max)/Ao);
 
-  for(size_t i = 0; i < N; i++)
+  size_t L = nlObjectsToUpdate.size();
+  std::vector<std::vector<char> > handled(L,std::vector<char>(N));
+  std::vector<char> handledByAny(N,false);
+#ifdef MDTK_OPENMP
+#pragma omp parallel for num_threads(forceThreads()) schedule(static)
+#endif
+  for(int i = 0; i < int(N); i++)
   {
-    Atom& atom_i = atoms_[i];
+    const Atom& atom_i = atoms_[i];
+    for(size_t nloi = 0; nloi < L; ++nloi)
+    {
+      bool h = nlObjectsToUpdate[nloi]->isHandled(atom_i);
+      handled[nloi][i] = h;
+      if (h) handledByAny[i] = true;
+    }
+  }
+
+  NeighbourSearch search(atoms_,handledByAny,sqrt(range_squared_max));
+
+// every pair is found once, from its lower index, and the rows are
+// completed afterwards. The rows are searched in blocks of consecutive
+// atoms, possibly by several threads, and the blocks are joined in order.
+  int threads = forceThreads();
+  size_t blockSize = (threads == 1)?std::max(N,size_t(1))
+                                   :N/(threads*NLBUILD_BLOCKS_PER_THREAD)+1;
+  size_t blocks = (N+blockSize-1)/blockSize;
+  std::vector<std::vector<std::vector<uint32_t> > >
+    blockIndices(blocks,std::vector<std::vector<uint32_t> >(L));
+  std::vector<std::vector<size_t> > halfOffsets(L,std::vector<size_t>(N+1,0));
+
+#ifdef MDTK_OPENMP
+#pragma omp parallel num_threads(threads)
+#endif
+  {
+    std::vector<uint32_t> js;
+    std::vector<Float> ds;
+#ifdef MDTK_OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+    for(int b = 0; b < int(blocks); b++)
+    {
+      size_t iend = std::min(N,(b+1)*blockSize);
+      for(size_t i = b*blockSize; i < iend; i++)
+      {
+        search.find(atoms_,i,i+1,js,ds);
+
+        for(size_t nloi = 0; nloi < L; ++nloi)
+        {
+          std::vector<uint32_t>& row = blockIndices[b][nloi];
+          size_t rowBegin = row.size();
+          if (handled[nloi][i])
+            for(size_t k = 0; k < js.size(); k++)
+            {
+              size_t j = js[k];
+              if (handled[nloi][j] && ds[k] < ranges_squared[nloi])
+                row.push_back(j);
+            }
+          std::sort(row.begin()+rowBegin,row.end());
+          halfOffsets[nloi][i+1] = row.size()-rowBegin;
+        }
+      }
+    }
+  }
 
-    for(size_t j = i+1; j < N; j++)
+  std::vector<std::vector<uint32_t> > halfIndices(L);
+  for(size_t nloi = 0; nloi < L; ++nloi)
+  {
+    for(size_t i = 0; i < N; i++)
+      halfOffsets[nloi][i+1] += halfOffsets[nloi][i];
+    if (blocks == 1)
     {
-      Atom& atom_j = atoms_[j];
+      halfIndices[nloi].swap(blockIndices[0][nloi]);
+      continue;
+    }
+    halfIndices[nloi].reserve(halfOffsets[nloi][N]);
+    for(size_t b = 0; b < blocks; b++)
+      halfIndices[nloi].insert(halfIndices[nloi].end(),
+                               blockIndices[b][nloi].begin(),
+                               blockIndices[b][nloi].end());
+  }
+
+  for(size_t nloi = 0; nloi < L; ++nloi)
+  {
+    NeighbourList& nlObject = *(nlObjectsToUpdate[nloi]);
+
+    nlObject.setRowsFromHalf(N,halfOffsets[nloi],halfIndices[nloi]);
+
+    for(size_t vi = 0; vi < nlObject.views.size(); ++vi)
+    {
+      NeighbourList& view = *(nlObject.views[vi]);
+      view.UpdateFromMaster(atoms_);
+      view.displacementsAtUpdate.clear();
+      view.ListUpdateRequested = false;
+    }
+  }
+}
+
+#define NLINCREMENTAL_FRACTION_MAX 0.25
+
+Float
+NeighbourList::incrementalThreshold() const
+{
+  Float skin_min = skin;
+  for(size_t vi = 0; vi < views.size(); ++vi)
+    if (skin_min > views[vi]->skin)
+      skin_min = views[vi]->skin;
+  return skin_min/2.0;
+}
+
+void
+NeighbourList::UpdateIncremental(AtomsArray& atoms_)
+{
+  REQUIRE(master == NULL);
+  REQUIRE(Rcutoff > 0.0);
+
+  size_t N = atoms_.size();
+  Float threshold = incrementalThreshold();
+
+  std::vector<char> active(N);
+  for(size_t i = 0; i < N; i++)
+    active[i] = isHandled(atoms_[i]);
+
+/*
+  The search reaches threshold beyond the listed range, so that the atoms
+  kept near a rebuilt one get their drift bounded as well.
+*/
+  NeighbourSearch search(atoms_,active,Rcutoff+skin+threshold);
+  Float listed_squared = SQR(Rcutoff+skin);
+
+// cells where some atom moved too far, and the cells around them
+  std::vector<std::vector<char> > cellDirty(search.groupPBC.size());
+  for(size_t g = 0; g < search.groupPBC.size(); g++)
+    cellDirty[g].resize(search.cells[g*(search.groupPBC.size()+1)].head.size(),false);
+
+  int c[3];
+  for(size_t i = 0; i < N; i++)
+  {
+    if (!active[i]) continue;
+    if (displacements[i].module() + driftBounds[i] <= threshold) continue;
+    const NeighbourCells& cells_ = search.ownCells(i);
+    cellDirty[search.groupOf[i]][cells_.cellIndex(atoms_[i],atoms_[i].PBC,c)] = true;
+  }
 
-      Float dij_squared = depos(atom_i,atom_j).module_squared();
+  std::vector<char> rebuilt(N,false);
+  size_t rebuiltCount = 0;
+  std::vector<int> cs[3];
+  for(size_t i = 0; i < N; i++)
+  {
+    if (!active[i]) continue;
+    const NeighbourCells& cells_ = search.ownCells(i);
+    const std::vector<char>& dirty = cellDirty[search.groupOf[i]];
+    cells_.cellIndex(atoms_[i],atoms_[i].PBC,c);
+    for(int d = 0; d < 3; d++)
+      cells_.stencil(d,c[d],cs[d]);
+    for(size_t ciz = 0; ciz < cs[2].size() && !rebuilt[i]; ciz++)
+    for(size_t ciy = 0; ciy < cs[1].size() && !rebuilt[i]; ciy++)
+    for(size_t cix = 0; cix < cs[0].size() && !rebuilt[i]; cix++)
+      if (dirty[(cs[2][ciz]*cells_.n[1]+cs[1][ciy])*cells_.n[0]+cs[0][cix]])
+        rebuilt[i] = true;
+    if (rebuilt[i]) rebuiltCount++;
+  }
+
+  if (rebuiltCount == 0)
+    return;
 
-      if (dij_squared > range_squared_max)
+  if (rebuiltCount > NLINCREMENTAL_FRACTION_MAX*N)
+  {
+    std::vector<NeighbourList*> nlObjectsToUpdate;
+    nlObjectsToUpdate.push_back(this);
+    Update(atoms_,nlObjectsToUpdate);
+    return;
+  }
+
+  {
+    int NLINCR = rebuiltCount;
+    TRACE(NLINCR);
+  }
+
+// pairs with a rebuilt atom are searched anew, the others are kept
+  std::vector<std::pair<uint32_t,uint32_t> > fresh;
+  std::vector<char> touched(N,false);
+  std::vector<uint32_t> js;
+  std::vector<Float> ds;
+  for(size_t i = 0; i < N; i++)
+  {
+    if (!rebuilt[i]) continue;
+    search.find(atoms_,i,0,js,ds);
+    for(size_t k = 0; k < js.size(); k++)
+    {
+      size_t j = js[k];
+      if (ds[k] > listed_squared)
+      {
+        if (!rebuilt[j])
+          touched[j] = true;
         continue;
+      }
+      if (rebuilt[j])
+      {
+        if (j > i)
+          fresh.push_back(std::make_pair(uint32_t(i),uint32_t(j)));
+      }
+      else
+      {
+        touched[j] = true;
+        fresh.push_back(std::make_pair(uint32_t(std::min(i,j)),
+                                       uint32_t(std::max(i,j))));
+      }
+    }
+  }
+  std::sort(fresh.begin(),fresh.end());
+
+  std::vector<size_t> halfOffsets(N+1);
+  std::vector<uint32_t> halfIndices;
+  halfIndices.reserve(indices.size()/2+fresh.size());
+  size_t f = 0;
+  for(size_t i = 0; i < N; i++)
+  {
+    halfOffsets[i] = halfIndices.size();
+    size_t kept = halfIndices.size();
+    if (!rebuilt[i])
+      for(size_t k = offsets[i]; k < offsets[i+1]; k++)
+      {
+        size_t j = indices[k];
+        if (j > i && !rebuilt[j])
+          halfIndices.push_back(j);
+      }
+    size_t fresh_begin = halfIndices.size();
+    for(; f < fresh.size() && fresh[f].first == i; f++)
+      halfIndices.push_back(fresh[f].second);
+    std::inplace_merge(halfIndices.begin()+kept,
+                       halfIndices.begin()+fresh_begin,
+                       halfIndices.end());
+  }
+  halfOffsets[N] = halfIndices.size();
+
+  setRowsFromHalf(N,halfOffsets,halfIndices);
+
+// a kept atom found near a rebuilt one may swing back through its
+// reference point, its drift so far counts against the threshold
+  for(size_t i = 0; i < N; i++)
+  {
+    if (rebuilt[i])
+    {
+      displacements[i] = Vector3D(0,0,0);
+      driftBounds[i] = 0.0;
+    }
+    else if (touched[i])
+      driftBounds[i] = std::max(driftBounds[i],displacements[i].module());
+  }
+
+  for(size_t vi = 0; vi < views.size(); ++vi)
+  {
+    NeighbourList& view = *(views[vi]);
+    view.UpdateFromMaster(atoms_,&rebuilt);
+    view.displacementsAtUpdate.clear();
+    view.ListUpdateRequested = false;
+  }
+}
 
-      for(size_t nloi = 0; nloi < nlObjectsToUpdate.size(); ++nloi)
+void
+NeighbourList::setRowsFromHalf(size_t N,
+                               std::vector<size_t>& halfOffsets,
+                               std::vector<uint32_t>& halfIndices)
+{
+  if (half)
+  {
+    offsets.swap(halfOffsets);
+    indices.swap(halfIndices);
+    connected.assign(N,false);
+    for(size_t i = 0; i < N; i++)
+      if (offsets[i+1] > offsets[i])
       {
-        NeighbourList& nlObject = *(nlObjectsToUpdate[nloi]);
+        connected[i] = true;
+        for(size_t k = offsets[i]; k < offsets[i+1]; k++)
+          connected[indices[k]] = true;
+      }
+    return;
+  }
+
+  offsets.assign(N+1,0);
+  for(size_t i = 0; i < N; i++)
+  {
+    offsets[i+1] += halfOffsets[i+1]-halfOffsets[i];
+    for(size_t k = halfOffsets[i]; k < halfOffsets[i+1]; k++)
+      offsets[halfIndices[k]+1]++;
+  }
+  for(size_t i = 0; i < N; i++)
+    offsets[i+1] += offsets[i];
 
-        if (!nlObject.fpot->isHandled(atom_i)) continue;
-        if (!nlObject.fpot->isHandled(atom_j)) continue;
-//      if (!nlObject.fpot->isHandledPair(atom_i,atom_j)) continue;
+  indices.resize(offsets[N]);
+  std::vector<size_t> pos(offsets.begin(),offsets.end()-1);
+// rows i' < i have already put their entries to row i
+  for(size_t i = 0; i < N; i++)
+    for(size_t k = halfOffsets[i]; k < halfOffsets[i+1]; k++)
+    {
+      uint32_t j = halfIndices[k];
+      indices[pos[i]++] = j;
+      indices[pos[j]++] = i;
+    }
+}
 
-//        REQUIRE(nlObject.Rcutoff > 0.0);
-//        PRINT("NL update\n");
-        Float range_squared = SQR((1.0+NLSKIN_FACTOR)*nlObject.Rcutoff);
+void
+NeighbourList::UpdateFromMaster(AtomsArray& atoms_, const std::vector<char>* rebuilt)
+{
+  REQUIRE(master != NULL);
 
-        if (dij_squared < range_squared)
-        {
-          nlObject.nl[i].push_back(&atom_j);
-          nlObject.nl[j].push_back(&atom_i);
-        }
+  size_t N = atoms_.size();
+
+  atoms = &atoms_;
+  displacementsAtUpdate = master->displacements;
+  displacementSum = 0.0;
+
+  std::vector<char> handled(N);
+  for(size_t i = 0; i < N; i++)
+    handled[i] = isHandled(atoms_[i]);
+
+  Float range_squared = SQR(Rcutoff+skin);
+
+  std::vector<size_t> halfOffsets(N+1);
+  std::vector<uint32_t> halfIndices;
+  halfIndices.reserve(half?indices.size():indices.size()/2);
+
+  for(size_t i = 0; i < N; i++)
+  {
+    halfOffsets[i] = halfIndices.size();
+
+    if (!handled[i]) continue;
+
+    Atom& atom_i = atoms_[i];
+
+// only the pairs with a rebuilt atom are taken from the master
+    size_t kept = halfIndices.size();
+    if (rebuilt && !(*rebuilt)[i])
+      for(size_t k = offsets[i]; k < offsets[i+1]; k++)
+      {
+        size_t j = indices[k];
+        if (j > i && !(*rebuilt)[j])
+          halfIndices.push_back(j);
       }
+    size_t fresh_begin = halfIndices.size();
+
+    for(size_t k = master->offsets[i]; k < master->offsets[i+1]; k++)
+    {
+      size_t j = master->indices[k];
+
+      if (j <= i) continue;
+      if (!handled[j]) continue;
+      if (rebuilt && !(*rebuilt)[i] && !(*rebuilt)[j]) continue;
+
+      if (depos(atom_i,atoms_[j]).module_squared() < range_squared)
+        halfIndices.push_back(j);
+    }
+
+    if (rebuilt)
+      std::inplace_merge(halfIndices.begin()+kept,
+                         halfIndices.begin()+fresh_begin,
+                         halfIndices.end());
+  }
+  halfOffsets[N] = halfIndices.size();
+
+  setRowsFromHalf(N,halfOffsets,halfIndices);
+}
+
+void
+NeighbourList::attachViews(const std::vector<NeighbourList*>& nlViews)
+{
+  views = nlViews;
+  Rcutoff = 0.0;
+  skin = 0.0;
+  for(size_t vi = 0; vi < views.size(); ++vi)
+  {
+    views[vi]->master = this;
+    if (Rcutoff+skin < views[vi]->Rcutoff+views[vi]->skin)
+    {
+      Rcutoff = views[vi]->Rcutoff;
+      skin = views[vi]->skin;
     }
   }
 }
 
+bool
+NeighbourList::isHandled(const Atom& atom) const
+{
+  if (fpot)
+    return fpot->isHandled(atom);
+
+  for(size_t vi = 0; vi < views.size(); ++vi)
+    if (views[vi]->isHandled(atom))
+      return true;
+
+  return false;
+}
+
+/*
+  Whether every pair of handled atoms closer than range is in the list.
+*/
+bool
+NeighbourList::listsPairsWithin(AtomsArray& atoms_, Float range) const
+{
+  size_t N = atoms_.size();
+  std::vector<char> active(N);
+  for(size_t i = 0; i < N; i++)
+    active[i] = isHandled(atoms_[i]);
+
+  NeighbourSearch search(atoms_,active,range);
+  std::vector<uint32_t> js;
+  std::vector<Float> ds;
+  for(size_t i = 0; i < N; i++)
+  {
+    search.find(atoms_,i,i+1,js,ds);
+    for(size_t k = 0; k < js.size(); k++)
+      if (!std::binary_search(indices.begin()+offsets[i],
+                              indices.begin()+offsets[i+1],js[k]))
+        return false;
+  }
+  return true;
+}
+
+bool
+NeighbourList::coveredByMaster() const
+{
+  REQUIRE(master != NULL);
+
+  return (Rcutoff + skin + master->displacementSum <=
+          master->Rcutoff + master->skin);
+}
+
 bool
 NeighbourList::MovedTooMuch(AtomsArray& atoms_)
 {
   REQUIRE(Rcutoff > 0.0);
 
+// the master is checked first, so its sum is current for the views
+// that were built together with it
+  if (master && displacementsAtUpdate.empty())
+  {
+    displacementSum = master->displacementSum;
+    return (displacementSum > skin);
+  }
+
+  if (incremental && !master)
+  {
+    Float threshold = incrementalThreshold();
+    for (size_t i = 0; i < atoms_.size(); i++)
+      if (displacements[i].module() + driftBounds[i] > threshold)
+        return true;
+#ifdef NLINCREMENTAL_CHECK
+    REQUIRE(listsPairsWithin(atoms_,Rcutoff));
+#endif
+    return false;
+  }
+
   Float disp1, disp2 ,disp;
   disp1 = 0.0;
   disp2 = 0.0;
@@ -117,7 +783,7 @@ NeighbourList::MovedTooMuch(AtomsArray& atoms_)
   atoms_count = atoms_.size();
   for (i = 0; i < atoms_count; i++)
   {
-   disp = displacements[i].module();
+   disp = displacement(i).module();
    if (disp >= disp1)
    {        
       disp2 = disp1;
@@ -129,9 +795,60 @@ NeighbourList::MovedTooMuch(AtomsArray& atoms_)
       disp2 = disp;
    }
   }
-  return (disp1 + disp2 > NLSKIN_FACTOR*Rcutoff);
+  displacementSum = disp1 + disp2;
+  return (displacementSum > skin);
 }
 
 
+#define NLTUNER_CPUTIME_MIN 1.0
+#define NLTUNER_FACTOR_MIN 1.05
+
+NeighbourSkinTuner::NeighbourSkinTuner()
+  : timer(), started(false),
+    cpuTimeAtChange(0.0), simTimeAtChange(0.0),
+    costPrev(0.0), factor(1.25), direction(-1),
+    enabled(false), scale(1.0), scaleMin(0.2), scaleMax(3.0),
+    simTime(0.0)
+{
 }
 
+bool
+NeighbourSkinTuner::rebuildStarts()
+{
+  Float cpuTime = timer.getTimeInSeconds();
+  if (!started)
+  {
+    started = true;
+    cpuTimeAtChange = cpuTime;
+    simTimeAtChange = simTime;
+    return false;
+  }
+
+  Float dCPUTime = cpuTime - cpuTimeAtChange;
+  Float dSimTime = simTime - simTimeAtChange;
+// the procmon timers tick in jiffies
+  if (dCPUTime < NLTUNER_CPUTIME_MIN || dSimTime <= 0.0)
+    return false;
+
+  Float cost = dCPUTime/dSimTime;
+  if (costPrev > 0.0 && cost > costPrev)
+  {
+    direction = -direction;
+    factor = sqrt(factor);
+    if (factor < NLTUNER_FACTOR_MIN) factor = NLTUNER_FACTOR_MIN;
+  }
+  costPrev = cost;
+
+  scale *= (direction > 0)?factor:(1.0/factor);
+  if (scale < scaleMin) scale = scaleMin;
+  if (scale > scaleMax) scale = scaleMax;
+
+  cpuTimeAtChange = cpuTime;
+  simTimeAtChange = simTime;
+
+  TRACE(scale);
+
+  return true;
+}
+
+}
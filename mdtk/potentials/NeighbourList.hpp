@@ -24,52 +24,189 @@
 #define mdtk_NeighbourList_hpp
 
 #include <vector>
+#include <stdint.h>
 #include <mdtk/Atom.hpp>
 #include <mdtk/AtomsContainer.hpp>
 #include <mdtk/Vector3D.hpp>
 #include <mdtk/config.hpp>
+#include <mdtk/consts.hpp>
 #include <mdtk/tools.hpp>
+#include <mdtk/procmon.hpp>
 
-
-#define MDTK_NB_RESERVE_ADD 5
+#define NLSKIN_DEFAULT (1.0*Ao)
 
 namespace mdtk
 {
 
 class FGeneral;
 
+/*
+  Neighbours of one atom as stored in a NeighbourList, indexed like the
+  AtomRefsContainer the lists used to be.
+*/
+class NeighbourRefs
+{
+  AtomsArray* atoms;
+  const uint32_t* indices;
+  size_t count;
+public:
+  NeighbourRefs(AtomsArray* a, const uint32_t* ind, size_t n)
+   : atoms(a), indices(ind), count(n)
+  {
+  }
+  size_t size() const {return count;}
+  Atom* operator[](size_t k) const {return &(*atoms)[indices[k]];}
+};
+
+/*
+  Runtime tuning of the skins. At a full rebuild of the lists the CPU
+  time spent per simulated time since the previous change of the skins
+  is compared with the one measured before it; the skins keep being
+  scaled in the same direction while the cost goes down, and are scaled
+  back with a finer step when it goes up.
+*/
+class NeighbourSkinTuner
+{
+  procmon::ProcmonTimer timer;
+  bool started;
+  Float cpuTimeAtChange;
+  Float simTimeAtChange;
+  Float costPrev;
+  Float factor;
+  int direction;
+public:
+  bool enabled;
+  Float scale;
+  Float scaleMin;
+  Float scaleMax;
+  Float simTime;
+  NeighbourSkinTuner();
+  bool rebuildStarts();
+};
+
 class NeighbourList
 {
   const FGeneral* fpot;
 public:
   bool ListUpdateRequested;
   Float Rcutoff;
-  std::vector<AtomRefsContainer> nl;
+/*
+  Pairs are listed up to Rcutoff+skin, and the list is valid until two
+  atoms may have approached each other by more than skin.
+*/
+  Float skin;
+/*
+  A half list stores every pair once, in the row of its lower index.
+*/
+  bool half;
+  std::vector<char> connected;
+/*
+  Compressed sparse rows: the neighbours of atom i are
+  atoms[indices[offsets[i]]] ... atoms[indices[offsets[i+1]-1]],
+  in ascending index order.
+*/
+  AtomsArray* atoms;
+  std::vector<size_t> offsets;
+  std::vector<uint32_t> indices;
   std::vector<Vector3D> displacements;
+/*
+  A list may serve as the master list for a number of views. The master
+  is built at the largest cutoff of its views and tracks displacements
+  for all of them; a view is refreshed by filtering the master. A view
+  rebuilt without its master keeps the master displacements it was
+  built at.
+*/
+  NeighbourList* master;
+  std::vector<NeighbourList*> views;
+  std::vector<Vector3D> displacementsAtUpdate;
+  Float displacementSum;
+/*
+  In the incremental mode a master rebuilds only the rows of atoms in the
+  cells where some atom has moved too far, and of the cells around them.
+  The rows of the other atoms are kept, so an atom may have been reached
+  by the search of a rebuilt atom after its own rebuild; driftBounds[i]
+  holds the largest displacement of atom i at such a search.
+*/
+  bool incremental;
+  std::vector<Float> driftBounds;
   NeighbourList(const FGeneral* pot)
    : fpot(pot), ListUpdateRequested(true),
-     Rcutoff(0.0),
-     nl(), displacements()
+     Rcutoff(0.0), skin(NLSKIN_DEFAULT),
+     half(false), connected(),
+     atoms(NULL), offsets(), indices(), displacements(),
+     master(NULL), views(),
+     displacementsAtUpdate(), displacementSum(0.0),
+     incremental(false), driftBounds()
   {
   }  
 
-  void init(AtomsArray& atoms)
+  void init(AtomsArray& atoms_)
   {
-    nl.clear();
+    atoms = &atoms_;
+    offsets.assign(atoms_.size()+1,0);
+    indices.clear();
+    connected.clear();
     displacements.clear();
-    nl.resize(atoms.size());
-
-    displacements.resize(atoms.size());
+    displacementsAtUpdate.clear();
+    displacementSum = 0.0;
+    driftBounds.clear();
+
+    if (!master)
+    {
+      displacements.resize(atoms_.size());
+      driftBounds.resize(atoms_.size());
+    }
     ListUpdateRequested = true;
   }  
 
+  NeighbourRefs neighbours(size_t i)
+  {
+    return NeighbourRefs(atoms,
+                         indices.empty()?NULL:&indices[0]+offsets[i],
+                         offsets[i+1]-offsets[i]);
+  }
+  bool hasNeighbours(size_t i) const
+  {
+    if (half)
+      return connected[i];
+    return offsets[i+1] > offsets[i];
+  }
+  void setRowsFromHalf(size_t N,
+                       std::vector<size_t>& halfOffsets,
+                       std::vector<uint32_t>& halfIndices);
+
+  void attachViews(const std::vector<NeighbourList*>&);
+
+  bool isHandled(const Atom&) const;
+
+  Vector3D displacement(size_t i) const
+  {
+    if (!master)
+      return displacements[i];
+    if (displacementsAtUpdate.empty())
+      return master->displacements[i];
+    return master->displacements[i] - displacementsAtUpdate[i];
+  }
+  void incDisplacement(size_t i, const Vector3D& inc)
+  {
+    if (master)
+      master->displacements[i] += inc;
+    else
+      displacements[i] += inc;
+  }
+
   void requestUpdate() {ListUpdateRequested = true;};
   void checkRequestUpdate(AtomsArray& atoms)
   {
     ListUpdateRequested = MovedTooMuch(atoms);
   };
   bool MovedTooMuch(AtomsArray&);
+  bool coveredByMaster() const;
+  bool listsPairsWithin(AtomsArray&, Float range) const;
+  void UpdateFromMaster(AtomsArray&, const std::vector<char>* rebuilt = NULL);
   static void Update(AtomsArray&, std::vector<NeighbourList*>&);
+  Float incrementalThreshold() const;
+  void UpdateIncremental(AtomsArray&);
 
   void SaveToStream(std::ostream& os, YAATK_FSTREAM_MODE smode)
   {
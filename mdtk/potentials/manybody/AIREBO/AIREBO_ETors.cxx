@@ -29,72 +29,92 @@
 namespace mdtk
 {
 
+namespace
+{
+
+/*
+  Hands the rows of a neighbour list over to another list, if any, for
+  the lifetime of the object, and takes them back afterwards; nothing is
+  copied.
+*/
+class NeighbourRowsLoan
+{
+  NeighbourList& from;
+  NeighbourList* to;
+public:
+  NeighbourRowsLoan(NeighbourList& f, NeighbourList* t)
+    :from(f),to(t)
+    {
+      if (!to) return;
+      to->atoms = from.atoms;
+      to->offsets.swap(from.offsets);
+      to->indices.swap(from.indices);
+    }
+  ~NeighbourRowsLoan()
+    {
+      if (!to) return;
+      to->offsets.swap(from.offsets);
+      to->indices.swap(from.indices);
+    }
+};
+
+}
+
 Float
 ETors::operator()(AtomsArray& gl)
 {
-  Float Ei = 0;
-  for(size_t ii = 0; ii < gl.size(); ii++)
+  NeighbourRowsLoan loan(nl,ownRebo?&ownRebo->nl:NULL);
+  if (ownRebo)
+    ownRebo->fillTables(gl);
+  REQUIRE(rebo.tablesAtoms == &gl);
+  REQUIRE(rebo.dihedralRows.size() == gl.size());
+  REQUIRE(rebo.tablesEpoch != reboEpoch);
+  reboEpoch = rebo.tablesEpoch;
+  return accumulateOverAtoms(*this,gl,&ETors::accumulateEnergy);
+}
+
+void
+ETors::accumulateEnergy(AtomsArray& gl, size_t ii, Float& Ei)
+{
+  Atom &atom_i = gl[ii];
+  const std::vector<REBO::Dihedral>& row = rebo.dihedralRows[ii];
+  if (row.empty()) return;
+
+  NeighbourRefs nli = rebo.NL(atom_i);
+  for(size_t jj = 0; jj < nli.size(); jj++)
   {
-    Atom &atom_i = gl[ii];
-    if (isHandled(atom_i))
+    const REBO::Bond& b = rebo.bonds[rebo.bondIndex(atom_i,jj)];
+    if (b.dihedralCount == 0) continue;
+
+    Atom &atom_j = *(nli[jj]);
+    AtomsPair ij(rebo.bond(atom_i,jj,atom_j));
+    NeighbourRefs nlj = rebo.NL(atom_j);
+    for(size_t d = b.firstDihedral; d < b.firstDihedral+b.dihedralCount; d++)
     {
-      AtomRefsContainer& nli = NL(atom_i);
-      for(size_t jj = 0; jj < nli.size(); jj++)
+      size_t k = row[d].k;
+      size_t l = row[d].l;
+      AtomsPair ki(rebo.reversedBond(atom_i,k,*nli[k]));
+      AtomsPair jl(rebo.bond(atom_j,l,*nlj[l]));
+
+      Float V = 1.0;
+
+      AtomsPair ik(-ki);
+
+      Float wki  = ki.f();
+      Float wij  = ij.f();
+      Float wjl  = jl.f();
+      Float VtorsVal = Vtors(ij,ik,jl,wki*wij*wjl*V);
+
+      if (V != 0)
       {
-        Atom &atom_j = *(nli[jj]);
-        if (atom_i.globalIndex > atom_j.globalIndex) continue;
-        if (&atom_i != &atom_j)
-        {
-          if (!probablyAreNeighbours(atom_i,atom_j)) continue;
-
-          AtomsPair ij(atom_i,atom_j,R(0,atom_i,atom_j),R(1,atom_i,atom_j));
-
-          for(size_t k = 0; k < nli.size(); k++)
-          {
-            Atom &atom_k = *(nli[k]);
-            if (&atom_k != &atom_i && &atom_k != &atom_j)
-            {
-              if (!probablyAreNeighbours(atom_i,atom_k)) continue;
-              AtomsPair ki(atom_k,atom_i,R(0,atom_k,atom_i),R(1,atom_k,atom_i));
-              AtomRefsContainer& nlj = NL(atom_j);
-              for(size_t l = 0; l < nlj.size(); l++)
-              {
-                Atom &atom_l = *(nlj[l]);
-                if (&atom_l != &atom_i && &atom_l != &atom_j &&  &atom_l != &atom_k )
-                {
-                  if (!probablyAreNeighbours(atom_j,atom_l)) continue;
-                  AtomsPair jl(atom_j,atom_l,R(0,atom_j,atom_l),R(1,atom_j,atom_l));
-
-                  if (fabs(SinTheta(ij,ki))<0.1) continue;
-                  if (fabs(SinTheta(ij,jl))<0.1) continue;
-
-                  Float V = 1.0;
-
-                  AtomsPair ik(-ki);
-
-                  Float wki  = ki.f();
-                  Float wij  = ij.f();
-                  Float wjl  = jl.f();
-                  Float VtorsVal = Vtors(ij,ik,jl,wki*wij*wjl*V);
-
-                  if (V != 0)
-                  {
-                    ki.f(wij*wjl*VtorsVal*V);
-                    ij.f(wki*wjl*VtorsVal*V);
-                    jl.f(wki*wij*VtorsVal*V);
-                  }
-
-                  Ei += wki*wij*wjl*VtorsVal;
-                }
-              }
-            }
-          }
-        }
+        ki.f(wij*wjl*VtorsVal*V);
+        ij.f(wki*wjl*VtorsVal*V);
+        jl.f(wki*wij*VtorsVal*V);
       }
+
+      Ei += wki*wij*wjl*VtorsVal;
     }
   }
-
-  return Ei;
 }
 
 Float
@@ -114,16 +134,41 @@ ETors::Vtors(AtomsPair& ij, AtomsPair& ik, AtomsPair& jl, const Float V)
   return Val;
 }
 
+ETors::ETors(REBO* crebo):
+  FManybody()
+  ,ownRebo(NULL)
+  ,rebo(*crebo)
+  ,reboEpoch(0)
+{
+  setupPotential();
+}
+
 ETors::ETors():
-  EREBO(REBO::POTENTIAL1)
+  FManybody()
+  ,ownRebo(new REBO())
+  ,rebo(*ownRebo)
+  ,reboEpoch(0)
 {
   setupPotential();
   nl.Rcutoff = getRcutoff();
 }
 
+ETors::~ETors()
+{
+  if (ownRebo)
+    delete ownRebo;
+}
+
 void
 ETors::setupPotential()
 {
+  handleElement(H_EL);
+  handleElement(C_EL);
+  handleElementPair(H_EL,C_EL);
+  handleElementPair(C_EL,H_EL);
+  handleElementPair(H_EL,H_EL);
+  handleElementPair(C_EL,C_EL);
+
   zetaCC_[C][C] = 0.3079*eV;
   zetaCC_[H][H] = 0.1250*eV;
   zetaCC_[C][H] = 0.1787*eV;
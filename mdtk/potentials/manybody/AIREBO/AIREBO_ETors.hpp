@@ -35,41 +35,71 @@
 #define ETORS_OPTIMIZED
 #define ETORS_OPTIMIZED_EVEN_BETTER
 
-#define EREBO REBO
-
 namespace mdtk
 {
 
-class ETors : public EREBO
+/*
+  Torsion term of AIREBO. It runs over the dihedral table of a REBO
+  instance. Built on the REBO of the simulation, it shares its tables,
+  so that REBO has to be evaluated first, and keeps no neighbour list
+  of its own. Built standalone, e.g. next to Brenner, it fills the
+  tables of a private REBO from its own list, lent to it for the call.
+*/
+class ETors : public FManybody
 {
+  REBO* ownRebo;
+  REBO& rebo;
+  unsigned long reboEpoch;
 public:
   virtual Float operator()(AtomsArray& nl);
+  void accumulateEnergy(AtomsArray& gl, size_t i, Float& Ei);
 
   Float Vtors(AtomsPair& ij, AtomsPair& ik, AtomsPair& jl, const Float V);
 
+  ETors(REBO* crebo);
   ETors();
-//  bool probablyAreNeighbours(Atom& atom1, Atom& atom2) const; not needed because of the same R[][][] values
+  virtual ~ETors();
+  Float getRcutoff() const {return rebo.getRcutoff();}
+
+  void NL_checkRequestUpdate(AtomsArray& atoms)
+    {
+      if (ownRebo)
+        FManybody::NL_checkRequestUpdate(atoms);
+    }
+  void NL_UpdateIfNeeded(AtomsArray& atoms)
+    {
+      if (ownRebo)
+        FManybody::NL_UpdateIfNeeded(atoms);
+    }
+  void NL_init(AtomsArray& atoms)
+    {
+      FManybody::NL_init(atoms);
+      if (!ownRebo)
+        nl.ListUpdateRequested = false;
+    }
 private:
   void setupPotential();
 
-  enum {ECOUNT = EREBO::ECOUNT};
-  enum {C = EREBO::C};
-  enum {H = EREBO::H};
+  enum {ECOUNT = REBO::ECOUNT};
+  enum {C = REBO::C};
+  enum {H = REBO::H};
 
   Float zetaCC(const Atom& atom1, const Atom& atom2) const
   {
-    return zetaCC_[EREBO::e2i(atom1)][EREBO::e2i(atom2)];
+    return zetaCC_[rebo.e2i(atom1)][rebo.e2i(atom2)];
   }
 
   Float zetaCC_[ECOUNT][ECOUNT];
 public:
   void SaveToStream(std::ostream& os, YAATK_FSTREAM_MODE smode)
   {
-    EREBO::SaveToStream(os,smode);
+    FManybody::SaveToStream(os,smode);
   }
   void LoadFromStream(std::istream& is, YAATK_FSTREAM_MODE smode)
   {
-    EREBO::LoadFromStream(is,smode);
+    FManybody::LoadFromStream(is,smode);
+    if (!ownRebo)
+      nl.ListUpdateRequested = false;
   }
 };
 
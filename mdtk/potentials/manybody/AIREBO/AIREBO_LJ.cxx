@@ -34,46 +34,59 @@ namespace mdtk
 Float
 AIREBO::operator()(AtomsArray& gl)
 {
-  cleanup_Cij();
+#ifdef AIREBO_USING_REBO
+  REQUIRE(rebo.tablesAtoms == &gl);
+  REQUIRE(rebo.tablesEpoch != reboEpoch);
+  REQUIRE(rebo.bonds.size() == rebo.nl.indices.size());
+  REQUIRE(rebo.bondOrderSlots.size() == rebo.bonds.size());
+  reboEpoch = rebo.tablesEpoch;
+#endif
+
   fill_Cij(gl);
 
-  Float Ei = 0;
-  for(size_t ii = 0; ii < gl.size(); ii++)
+#ifdef AIREBO_USING_REBO
+  BijMemo none;
+  none.atom1 = none.atom2 = gl.size();
+  BijMemos.assign(forceThreads(),none);
+#endif
+
+  return accumulateOverAtoms(*this,gl,&AIREBO::accumulateEnergy);
+}
+
+void
+AIREBO::accumulateEnergy(AtomsArray& gl, size_t ii, Float& Ei)
+{
+  Atom &atom_i = gl[ii];
+  if (isHandled(atom_i))
   {
-    Atom &atom_i = gl[ii];
-    if (isHandled(atom_i))
+    NeighbourRefs nli = NL(atom_i);
+    for(size_t jj = 0; jj < nli.size(); jj++)
     {
-      AtomRefsContainer& nli = NL(atom_i);
-      for(size_t jj = 0; jj < nli.size(); jj++)
+      Atom &atom_j = *(nli[jj]);
+      if (atom_i.globalIndex > atom_j.globalIndex) continue;
+      if (&atom_i != &atom_j)
       {
-        Atom &atom_j = *(nli[jj]);
-        if (atom_i.globalIndex > atom_j.globalIndex) continue;
-        if (&atom_i != &atom_j)
-        {
-          if (!probablyAreNeighbours(atom_i,atom_j)) continue;
-          AtomsPair ij(atom_i,atom_j,R(0,atom_i,atom_j),R(1,atom_i,atom_j));
+        if (!probablyAreNeighbours(atom_i,atom_j)) continue;
+        AtomsPair ij(atom_i,atom_j,R(0,atom_i,atom_j),R(1,atom_i,atom_j));
 
-          Float V = 1.0;
+        Float V = 1.0;
 
-          Float C = Cij(ij);
+        Float C = Cij(ij);
 
-          if (C > 0.0) // C !=0.0
+        if (C > 0.0) // C !=0.0
+        {
+          Float SrSb = StrStb(ij);
+          Float LJ = VLJ(ij,SrSb*C*V);
+          if (V != 0)
           {
-            Float SrSb = StrStb(ij);
-            Float LJ = VLJ(ij,SrSb*C*V);
-            if (V != 0)
-            {
-              StrStb(ij,C*LJ*V);
-              Cij(ij,SrSb*LJ*V);
-            }
-            Ei += SrSb*C*LJ;
+            StrStb(ij,C*LJ*V);
+            Cij(ij,SrSb*LJ*V);
           }
+          Ei += SrSb*C*LJ;
         }
       }
     }
   }
-
-  return Ei;
 }
 
 inline
@@ -191,40 +204,52 @@ AIREBO::VLJ(AtomsPair& ij, const Float V)
 Float
 AIREBO::BijAsterix(AtomsPair& ij, const Float V)
 {
-  Float bij = 0.0;
-
   AtomsPair ijAsterix(ij.atom1,ij.atom2,
                       rebo.R(0,ij.atom1,ij.atom2),rebo.R(1,ij.atom1,ij.atom2),
                       rebo.R(0,ij.atom1,ij.atom2));
-  bij = rebo.Baver(ijAsterix, V);
-
-  return bij;
+#ifdef AIREBO_USING_REBO
+  BijMemo& memo = BijMemos[(BijMemos.size() == 1)?0:forceThread()];
+  if (memo.atom1 != ij.atom1.globalIndex || memo.atom2 != ij.atom2.globalIndex)
+  {
+    const REBO::BondOrder* published = rebo.publishedBondOrder(ij.atom1,ij.atom2);
+    if (published)
+      memo.bo = *published;
+    else
+      rebo.bondOrder(ijAsterix,memo.bo);
+    memo.atom1 = ij.atom1.globalIndex;
+    memo.atom2 = ij.atom2.globalIndex;
+  }
+  rebo.bondOrderDerivatives(ijAsterix,memo.bo,V,true);
+  return memo.bo.value;
+#else
+  return rebo.Baver(ijAsterix, V);
+#endif
 }
 
 AIREBO::AIREBO(CREBO* crebo):
   FManybody()
   ,rebo(*crebo)
   ,CA()
+  ,CijSlots()
+#ifdef AIREBO_USING_REBO
+  ,BijMemos()
+  ,reboEpoch(0)
+#endif
 {
   setupPotential();
 
   nl.Rcutoff = getRcutoff();
 }
 
-AIREBO::~AIREBO()
-{
-  cleanup_Cij();
-}
-
 void
 AIREBO::setupPotential()
 {
-  handledElements.insert(H_EL);
-  handledElements.insert(C_EL);
-  handledElementPairs.insert(std::make_pair(H_EL,C_EL));
-  handledElementPairs.insert(std::make_pair(C_EL,H_EL));
-  handledElementPairs.insert(std::make_pair(H_EL,H_EL));
-  handledElementPairs.insert(std::make_pair(C_EL,C_EL));
+  handleElement(H_EL);
+  handleElement(C_EL);
+  handleElementPair(H_EL,C_EL);
+  handleElementPair(C_EL,H_EL);
+  handleElementPair(H_EL,H_EL);
+  handleElementPair(C_EL,C_EL);
 
   sigma_[C][C] = 3.40*Ao;
   sigma_[H][H] = 2.65*Ao;
@@ -286,95 +311,106 @@ AIREBO::setupPotential()
   PRINT("AIREBO::LJ interatomic potential configured.\n");
 }
 
+/*
+  The path of atom1 to atomN, if a path of new_w with bondCount bonds
+  replaces it, or NULL. A path of equal weight is replaced only by a
+  shorter one.
+*/
+inline
+AIREBO::CijPath*
+AIREBO::CijUpdate(std::vector<CijPath>& paths, std::vector<int>& slots,
+                  Atom& atom1, Atom& atomN, Float new_w, size_t bondCount)
+{
+  int& slot = slots[atomN.globalIndex];
+  if (slot < 0)
+  {
+    if (atomN.globalIndex <= atom1.globalIndex ||
+        !probablyAreNeighbours(atom1,atomN))
+      return NULL;
+    CijPath p;
+    p.atom = atomN.globalIndex;
+    p.bondCount = 0;
+    p.w = 0.0;
+    slot = paths.size();
+    paths.push_back(p);
+  }
+  CijPath& p = paths[slot];
+  Float w = p.w;
+  if (new_w > w || (w > 0.0 && new_w == w && p.bondCount > bondCount))
+  {
+    p.w = new_w;
+    p.bondCount = bondCount;
+    return &p;
+  }
+  return NULL;
+}
+
 void
 AIREBO::fill_Cij(AtomsArray& gl)
 {
   CA.resize(gl.size());
+  int threads = forceThreads();
+  if (int(CijSlots.size()) < threads)
+    CijSlots.resize(threads);
 
-  for(size_t i1 = 0; i1 < gl.size(); i1++)
+// every atom fills only its own row of CA
+#ifdef MDTK_OPENMP
+#pragma omp parallel for num_threads(threads) schedule(static,FORCE_THREADS_CHUNK)
+#endif
+  for(int i1 = 0; i1 < int(gl.size()); i1++)
   {
+    std::vector<CijPath>& paths = CA[i1];
+    paths.clear();
     Atom &atom1 = gl[i1];
-    if (isHandled(atom1))
+    if (!isHandled(atom1)) continue;
+    std::vector<int>& slots = CijSlots[forceThread()];
+    if (slots.size() != gl.size())
+      slots.assign(gl.size(),-1);
+
+    NeighbourRefs nl1 = rebo.NL(atom1);
+    for(size_t i2 = 0; i2 < nl1.size(); i2++)
     {
-      AtomRefsContainer& nl1 = rebo.NL(atom1);
-      for(size_t i2 = 0; i2 < nl1.size(); i2++)
+      Atom &atom2 = *(nl1[i2]);
+      if (!reboBonded(atom1,i2,atom2)) continue;
+      Float f1 = reboBond(atom1,i2,atom2).f();
+      CijPath* p = CijUpdate(paths,slots,atom1,atom2,f1,1);
+      if (p)
+        p->neighbour[0] = i2;
+      NeighbourRefs nl2 = rebo.NL(atom2);
+      for(size_t i3 = 0; i3 < nl2.size(); i3++)
       {
-        Atom &atom2 = *(nl1[i2]);
-        if (!rebo.probablyAreNeighbours(atom1,atom2)) continue;
-        CEelement& pa
-          = CA[atom1.globalIndex][atom2.globalIndex];
-        Float w = pa.first;
-        AtomsPair p1(atom1,atom2,
-                     rebo.R(0,atom1,atom2),
-                     rebo.R(1,atom1,atom2));
-        Float new_w = p1.f();
-        if (new_w > w || (w > 0.0 && new_w == w && pa.second.size() > 1))
+        Atom &atom3 = *(nl2[i3]);
+        if (!reboBonded(atom2,i3,atom3)) continue;
+        Float f2 = reboBond(atom2,i3,atom3).f();
+        p = CijUpdate(paths,slots,atom1,atom3,f1*f2,2);
+        if (p)
         {
-          for(size_t pj = 0; pj < pa.second.size(); ++pj)
-            delete pa.second[pj];
-          pa.second.clear();
-          pa.first = new_w;
-          pa.second.push_back(new AtomsPair(p1));
+          p->via[0] = atom2.globalIndex;
+          p->neighbour[0] = i2;
+          p->neighbour[1] = i3;
         }
-        AtomRefsContainer& nl2 = rebo.NL(atom2);
-        for(size_t i3 = 0; i3 < nl2.size(); i3++)
+        NeighbourRefs nl3 = rebo.NL(atom3);
+        for(size_t i4 = 0; i4 < nl3.size(); i4++)
         {
-          Atom &atom3 = *(nl2[i3]);
-          if (!rebo.probablyAreNeighbours(atom2,atom3)) continue;
-          CEelement& pa
-            = CA[atom1.globalIndex][atom3.globalIndex];
-          Float w = pa.first;
-          AtomsPair p2(atom2,atom3,
-                       rebo.R(0,atom2,atom3),
-                       rebo.R(1,atom2,atom3));
-          Float new_w = p1.f()*p2.f();
-          if (new_w > w || (w > 0.0 && new_w == w && pa.second.size() > 2))
+          Atom &atom4 = *(nl3[i4]);
+          if (!reboBonded(atom3,i4,atom4)) continue;
+          Float f3 = reboBond(atom3,i4,atom4).f();
+          p = CijUpdate(paths,slots,atom1,atom4,f1*f2*f3,3);
+          if (p)
           {
-            for(size_t pj = 0; pj < pa.second.size(); ++pj)
-              delete pa.second[pj];
-            pa.second.clear();
-            pa.first = new_w;
-            pa.second.push_back(new AtomsPair(p1));
-            pa.second.push_back(new AtomsPair(p2));
-          }
-          AtomRefsContainer& nl3 = rebo.NL(atom3);
-          for(size_t i4 = 0; i4 < nl3.size(); i4++)
-          {
-            Atom &atom4 = *(nl3[i4]);
-            if (!rebo.probablyAreNeighbours(atom3,atom4)) continue;
-            CEelement& pa
-              = CA[atom1.globalIndex][atom4.globalIndex];
-            Float w = pa.first;
-            AtomsPair p3(atom3,atom4,
-                         rebo.R(0,atom3,atom4),
-                         rebo.R(1,atom3,atom4));
-            Float new_w = p1.f()*p2.f()*p3.f();
-            if (new_w > w/* || (w > 0.0 && new_w == w && pa.second.size() > 3)*/)
-            {
-              for(size_t pj = 0; pj < pa.second.size(); ++pj)
-                delete pa.second[pj];
-              pa.second.clear();
-              pa.first = new_w;
-              pa.second.push_back(new AtomsPair(p1));
-              pa.second.push_back(new AtomsPair(p2));
-              pa.second.push_back(new AtomsPair(p3));
-            }
+            p->via[0] = atom2.globalIndex;
+            p->via[1] = atom3.globalIndex;
+            p->neighbour[0] = i2;
+            p->neighbour[1] = i3;
+            p->neighbour[2] = i4;
           }
         }
       }
     }
-  }
-}
 
-void
-AIREBO::cleanup_Cij()
-{
-  for(size_t i = 0; i < CA.size(); i++)
-  {
-    for(CArray::iterator ca = CA[i].begin(); ca != CA[i].end(); ++ca)
-      for(size_t pj = 0; pj < ca->second.second.size(); ++pj)
-        delete ca->second.second[pj];
-    CA[i].clear();
+    for(size_t pi = 0; pi < paths.size(); pi++)
+      slots[paths[pi].atom] = -1;
+    std::sort(paths.begin(),paths.end());
   }
 }
 
@@ -382,24 +418,38 @@ inline
 Float
 AIREBO::Cij(AtomsPair& ij, const Float V)
 {
-  CArray::iterator cel
-    = CA[ij.atom1.globalIndex].find(ij.atom2.globalIndex);
+  const std::vector<CijPath>& paths = CA[ij.atom1.globalIndex];
+  CijPath key;
+  key.atom = ij.atom2.globalIndex;
+  std::vector<CijPath>::const_iterator p
+    = std::lower_bound(paths.begin(),paths.end(),key);
 
   Float w = 0.0;
 
-  if (cel != CA[ij.atom1.globalIndex].end())
+  if (p != paths.end() && p->atom == key.atom)
   {
-    w = cel->second.first;
+    w = p->w;
 
     if (V != 0.0)
     {
-      for(size_t pi = 0; pi < cel->second.second.size(); ++pi)
+      AtomsArray& gl = *nl.atoms;
+      Atom* chain[4];
+      chain[0] = &ij.atom1;
+      for(size_t pi = 1; pi < p->bondCount; ++pi)
+        chain[pi] = &gl[p->via[pi-1]];
+      chain[p->bondCount] = &ij.atom2;
+
+      Float f[3];
+      for(size_t pi = 0; pi < p->bondCount; ++pi)
+        f[pi] = reboBond(*chain[pi],p->neighbour[pi],*chain[pi+1]).f();
+
+      for(size_t pi = 0; pi < p->bondCount; ++pi)
       {
         Float m = 1.0;
-        for(size_t pj = 0; pj < cel->second.second.size(); ++pj)
+        for(size_t pj = 0; pj < p->bondCount; ++pj)
           if (pi != pj)
-            m *= (cel->second.second)[pj]->f();
-        (cel->second.second)[pi]->f(-m*V);
+            m *= f[pj];
+        reboBond(*chain[pi],p->neighbour[pi],*chain[pi+1]).f(-m*V);
       }
     }
   }
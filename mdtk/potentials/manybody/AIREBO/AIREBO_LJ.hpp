@@ -28,7 +28,7 @@
 
 #include <cstdlib>
 #include <cctype>
-#include <map>
+#include <stdint.h>
 
 #include <mdtk/potentials/manybody/FManybody.hpp>
 #include <mdtk/potentials/manybody/AIREBO/REBO.hpp>
@@ -71,19 +71,73 @@ class AIREBO : public FManybody
 
   Float Vtors(AtomsPair& ij, AtomsPair& ik, AtomsPair& jl, const Float V = 0.0);
 
-  typedef std::pair<Float,std::vector<AtomsPair*> > CEelement;
-  typedef std::map<size_t, CEelement> CArray;
-  std::vector<CArray> CA;
+/*
+  Connectivity switch: for every atom, the strongest path of at most
+  three REBO bonds to each atom of a higher index within the LJ cutoff,
+  sorted by that index. A path is kept as its atoms and the positions of
+  its bonds in the REBO neighbour rows; the rows and the per-thread
+  slots keep their storage from one evaluation to the next.
+*/
+  struct CijPath
+  {
+    uint32_t atom;
+    uint32_t via[2];
+    uint32_t neighbour[3];
+    unsigned char bondCount;
+    Float w;
+    bool operator<(const CijPath& p) const {return atom < p.atom;}
+  };
+  std::vector<std::vector<CijPath> > CA;
+  std::vector<std::vector<int> > CijSlots;
   void  fill_Cij(AtomsArray& gl);
-  void  cleanup_Cij();
+  CijPath* CijUpdate(std::vector<CijPath>& paths, std::vector<int>& slots,
+                     Atom& atom1, Atom& atomN, Float new_w, size_t bondCount);
   Float Cij(AtomsPair& ij, const Float V = 0.0);
 
   Float BijAsterix(AtomsPair& ij, const Float V = 0.0);
+#ifdef AIREBO_USING_REBO
+/*
+  StrStb asks for the bond order of the same pair up to three times in
+  a row, so each thread keeps the last one it got, keyed by (i,j).
+*/
+  struct BijMemo
+  {
+    size_t atom1;
+    size_t atom2;
+    REBO::BondOrder bo;
+  };
+  std::vector<BijMemo> BijMemos;
+/*
+  tablesEpoch of the REBO tables read by the previous evaluation.
+*/
+  unsigned long reboEpoch;
+#endif
+
+// the pair of atom1 with its k-th neighbour in the REBO list
+#ifdef AIREBO_USING_REBO
+  bool reboBonded(Atom& atom1, size_t k, Atom& /*atom2*/) const
+    {
+      return rebo.bonded(atom1,k);
+    }
+  AtomsPair reboBond(Atom& atom1, size_t k, Atom& atom2) const
+    {
+      return rebo.bond(atom1,k,atom2);
+    }
+#else
+  bool reboBonded(Atom& atom1, size_t /*k*/, Atom& atom2) const
+    {
+      return rebo.probablyAreNeighbours(atom1,atom2);
+    }
+  AtomsPair reboBond(Atom& atom1, size_t /*k*/, Atom& atom2) const
+    {
+      return AtomsPair(atom1,atom2,rebo.R(0,atom1,atom2),rebo.R(1,atom1,atom2));
+    }
+#endif
 public:
   virtual Float operator()(AtomsArray& nl);
+  void accumulateEnergy(AtomsArray& gl, size_t i, Float& Ei);
 
   AIREBO(CREBO* crebo);
-  virtual ~AIREBO();
 //  virtual
   Float getRcutoff() const {return      max3(R_[C][C][1],R_[C][H][1],R_[H][H][1]);}
   bool probablyAreNeighbours(const Atom& atom1, const Atom& atom2) const
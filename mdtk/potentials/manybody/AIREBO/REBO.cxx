@@ -33,35 +33,38 @@ Float
 REBO::operator()(AtomsArray& gl)
 {
   countNeighbours(gl);
-  Float Ei = 0;
-  for(size_t ii = 0; ii < gl.size(); ii++)
+  return accumulateOverAtoms(*this,gl,&REBO::accumulateEnergy);
+}
+
+void
+REBO::accumulateEnergy(AtomsArray& gl, size_t ii, Float& Ei)
+{
+  Atom &atom_i = gl[ii];
+  if (isHandled(atom_i))
   {
-    Atom &atom_i = gl[ii];
-    if (isHandled(atom_i))
+    NeighbourRefs nli = NL(atom_i);
+    for(size_t jj = 0; jj < nli.size(); jj++)
     {
-      AtomRefsContainer& nli = NL(atom_i);
-      for(size_t jj = 0; jj < nli.size(); jj++)
+      Atom &atom_j = *(nli[jj]);
+      if (atom_i.globalIndex > atom_j.globalIndex) continue;
+      if (&atom_i != &atom_j)
       {
-        Atom &atom_j = *(nli[jj]);
-        if (atom_i.globalIndex > atom_j.globalIndex) continue;
-        if (&atom_i != &atom_j)
+        if (!bonded(atom_i,jj)) continue;
+        AtomsPair ij(bond(atom_i,jj,atom_j));
+
+        Float VAvar = VA(ij);
+        Ei += VR(ij,1.0);
+        if (VAvar != 0.0)
         {
-          if (!probablyAreNeighbours(atom_i,atom_j)) continue;
-          AtomsPair ij(atom_i,atom_j,R(0,atom_i,atom_j),R(1,atom_i,atom_j));
-
-          Float VAvar = VA(ij);
-          Ei += VR(ij,1.0);
-          if (VAvar != 0.0)
-          {
-            Float BaverVal = Baver(ij,VAvar);
-            Ei += BaverVal*VA(ij,BaverVal);
-          }
+          BondOrder bo;
+          bondOrder(ij,bo,VAvar);
+          bondOrderDerivatives(ij,bo,VAvar,false);
+          publishBondOrder(bondIndex(atom_i,jj),ij,bo);
+          Ei += bo.value*VA(ij,bo.value);
         }
       }
     }
   }
-
-  return Ei;
 }
 
 inline
@@ -197,17 +200,139 @@ REBO::VA(AtomsPair& ij, const Float V)
   return -f*Val;
 }
 
-Float
-REBO::Baver(AtomsPair& ij, const Float V)
+/*
+  The bond order is evaluated in two passes. The forward pass computes
+  every term once and keeps the values the derivatives depend on, the
+  gradients of pi_rc and Tij among them. The adjoint pass then pushes
+  the derivatives of D, Nt and Nconj once, with the weights of all the
+  terms they enter summed up. The dihedral sum is
+  walked once when its weight V is known up front, as it is to REBO.
+*/
+void
+REBO::bondOrder(AtomsPair& ij, BondOrder& bo, const Float V)
 {
   AtomsPair ji(-ij);
 
-  return (p_sigma_pi(ij,V/2.0)+p_sigma_pi(ji,V/2.0))/2.0
-    +pi_rc(ij,V)
+  bo.D_ij = D(ij);
+  bo.D_ji = D(ji);
+  bo.value = (pow(bo.D_ij,-0.5)+pow(bo.D_ji,-0.5))/2.0;
+
+  bo.swapped = (ij.atom1.ID == H_EL && ij.atom2.ID == C_EL);
+  AtomsPair& pij = bo.swapped?ji:ij;
+  AtomsPair& pji = bo.swapped?ij:ji;
+
+  bo.Nti = Nt(pij);
+  bo.Ntj = Nt(pji);
+  bo.sum1 = NconjSum1(pij);
+  bo.sum2 = NconjSum2(pij);
+  bo.Nconj = 1.0 + SQR(bo.sum1) + SQR(bo.sum2);
+
+  Float* dPi = bo.dPi_rc;
+  dPi[0] = dPi[1] = dPi[2] = 0.0;
+  if (pij.atom1.ID == C_EL && pij.atom2.ID == C_EL)
+    bo.value += pi_rc_CC_num(bo.Nti,bo.Ntj,bo.Nconj,dPi[0],dPi[1],dPi[2]);
+  else if (pij.atom1.ID == C_EL && pij.atom2.ID == H_EL)
+    bo.value += pi_rc_CH_num(bo.Nti,bo.Ntj,bo.Nconj,dPi[0],dPi[1],dPi[2]);
+  else if (pij.atom1.ID == H_EL && pij.atom2.ID == H_EL)
+    bo.value += pi_rc_HH_num(bo.Nti,bo.Ntj,bo.Nconj,dPi[0],dPi[1],dPi[2]);
+
+  bo.TijVal = 0.0;
+  bo.dihedralSum = 0.0;
+  bo.dTij[0] = bo.dTij[1] = bo.dTij[2] = 0.0;
 #ifdef REBO_DIHEDRAL
-    +pi_dh(ij,V)
+  if (ij.atom1.ID == C_EL && ij.atom2.ID == C_EL)
+  {
+    bo.TijVal = Tij_num(bo.Nti,bo.Ntj,bo.Nconj,
+                        bo.dTij[0],bo.dTij[1],bo.dTij[2]);
+    if (bo.TijVal != 0.0)
+    {
+      bo.dihedralSum = pi_dh_sum(ij,bo.TijVal*V);
+      bo.value += bo.TijVal*bo.dihedralSum;
+    }
+  }
 #endif
-    ;
+}
+
+void
+REBO::bondOrderDerivatives(AtomsPair& ij, const BondOrder& bo,
+                           const Float V, bool pushDihedral)
+{
+  if (V == 0.0) return;
+
+  if (pushDihedral && bo.TijVal != 0.0)
+    pi_dh_sum(ij,bo.TijVal*V);
+
+  AtomsPair ji(-ij);
+
+  AtomsPair& pij = bo.swapped?ji:ij;
+  AtomsPair& pji = bo.swapped?ij:ji;
+
+  Float dNti = bo.dPi_rc[0]*V;
+  Float dNtj = bo.dPi_rc[1]*V;
+  Float dNconj = bo.dPi_rc[2]*V;
+
+  if (bo.dihedralSum != 0.0)
+  {
+    Float temp_sum = bo.dihedralSum;
+    dNti += bo.dTij[0]*temp_sum*V;
+    dNtj += bo.dTij[1]*temp_sum*V;
+    dNconj += bo.dTij[2]*temp_sum*V;
+  }
+
+  D(ij,-0.5*pow(bo.D_ij,-0.5-1.0)*(V/2.0));
+  D(ji,-0.5*pow(bo.D_ji,-0.5-1.0)*(V/2.0));
+
+  Nt_donly(pij,dNti);
+  Nt_donly(pji,dNtj);
+  if (dNconj != 0.0)
+  {
+    if (bo.sum1 != 0.0)
+      NconjSum1(pij,2.0*bo.sum1*dNconj);
+    if (bo.sum2 != 0.0)
+      NconjSum2(pij,2.0*bo.sum2*dNconj);
+  }
+}
+
+Float
+REBO::Baver(AtomsPair& ij, const Float V)
+{
+  BondOrder bo;
+  bondOrder(ij,bo,V);
+  bondOrderDerivatives(ij,bo,V,false);
+  return bo.value;
+}
+
+/*
+  Only the C-C bonds that are not yet full are published: AIREBO skips
+  the full ones, and its bond order of a pair with hydrogen is taken at
+  a shifted distance, so REBO's value does not apply to it.
+*/
+inline
+void
+REBO::publishBondOrder(size_t b, AtomsPair& ij, const BondOrder& bo)
+{
+  if (ij.atom1.ID != C_EL || ij.atom2.ID != C_EL || ij.f() == 1.0)
+    return;
+  int threads = bondOrderRows.size();
+  int t = (threads == 1)?0:forceThread();
+  bondOrderSlots[b] = t+threads*bondOrderRows[t].size();
+  bondOrderRows[t].push_back(bo);
+}
+
+const REBO::BondOrder*
+REBO::publishedBondOrder(Atom& atom_i, Atom& atom_j)
+{
+  if (atom_i.ID != C_EL || atom_j.ID != C_EL ||
+      atom_i.globalIndex > atom_j.globalIndex)
+    return NULL;
+  size_t k;
+  if (!findBond(atom_i,atom_j,k))
+    return NULL;
+  int slot = bondOrderSlots[bondIndex(atom_i,k)];
+  if (slot < 0)
+    return NULL;
+  int threads = bondOrderRows.size();
+  return &bondOrderRows[slot%threads][slot/threads];
 }
 
 inline
@@ -236,14 +361,14 @@ Float
 REBO::D(AtomsPair& ij, const Float V)
 {
   Float Dij = 1.0;
-  AtomRefsContainer& nli = NL(ij.atom1);
+  NeighbourRefs nli = NL(ij.atom1);
   for(size_t k = 0; k < nli.size(); k++)
   {
     Atom& atom_k = *(nli[k]);
     if (&atom_k != &ij.atom2/* && &atom_k != &atom1*/)
     {
-      if (!probablyAreNeighbours(ij.atom1,atom_k)) continue;
-      AtomsPair ik(ij.atom1,atom_k,R(0,ij.atom1,atom_k),R(1,ij.atom1,atom_k));
+      if (!bonded(ij.atom1,k)) continue;
+      AtomsPair ik(bond(ij.atom1,k,atom_k));
 
       Float ExpTermvar = ExpTerm(ij,ik);
       if (ExpTermvar != 0.0)
@@ -264,19 +389,6 @@ REBO::D(AtomsPair& ij, const Float V)
   return Dij;
 }
 
-inline
-Float
-REBO::p_sigma_pi(AtomsPair& ij, const Float V)
-{
-  Float DVal = D(ij);
-  if (V != 0)
-  {
-    Float Der = -0.5*pow(DVal,-0.5-1.0);
-    D(ij,Der*V);
-  };
-  return pow(DVal,-0.5);
-}
-
 inline
 Float
 REBO::G(AtomsPair& ij, AtomsPair& ik, const Float V)
@@ -291,33 +403,36 @@ REBO::G(AtomsPair& ij, AtomsPair& ik, const Float V)
     Float N = Nt(ij);
     Float Sp = Sprime(N,Nt1,Nt2);
 
-    Float funcGC1 = funcG_C1(CosT);
-    Float funcGC2 = funcG_C2(CosT);
-
-    if (V != 0.0)
+    if (V == 0.0)
     {
-      Float SpDer = dSprime(N,Nt1,Nt2);
-      Float funcGC1Der = funcG_C1.dCosT(CosT);
-      Float funcGC2Der = funcG_C2.dCosT(CosT);
+      Float funcGC1 = funcG_C1(CosT);
+      Float funcGC2 = funcG_C2(CosT);
+      return funcGC2+Sp*(funcGC1 - funcGC2);
+    }
 
-      if (funcGC2Der != 0.0 || funcGC1Der != 0.0)
-        CosTheta(ij,ik,funcGC2Der*V + funcGC1Der*Sp*V + (-funcGC2Der*Sp*V));
+    Float funcGC1Der, funcGC2Der;
+    Float funcGC1 = funcG_C1(CosT,funcGC1Der);
+    Float funcGC2 = funcG_C2(CosT,funcGC2Der);
+    Float SpDer = dSprime(N,Nt1,Nt2);
 
-      if ((funcGC2 != 0.0 || funcGC1 != 0.0) && SpDer != 0.0)
-        Nt_donly(ij,funcGC1*SpDer*V + (-funcGC2*SpDer*V));
-    }
+    if (funcGC2Der != 0.0 || funcGC1Der != 0.0)
+      CosTheta(ij,ik,funcGC2Der*V + funcGC1Der*Sp*V + (-funcGC2Der*Sp*V));
+
+    if ((funcGC2 != 0.0 || funcGC1 != 0.0) && SpDer != 0.0)
+      Nt_donly(ij,funcGC1*SpDer*V + (-funcGC2*SpDer*V));
 
     return funcGC2+Sp*(funcGC1 - funcGC2);
   }
   else if (ij.atom1.ID == H_EL)
   {
-    if (V != 0.0)
-    {
-      Float funcGHDer = funcG_H.dCosT(CosT);
-      if (funcGHDer != 0.0)
-        CosTheta(ij,ik,funcGHDer*V);
-    }
-    return funcG_H(CosT);
+    if (V == 0.0)
+      return funcG_H(CosT);
+
+    Float funcGHDer;
+    Float funcGH = funcG_H(CosT,funcGHDer);
+    if (funcGHDer != 0.0)
+      CosTheta(ij,ik,funcGHDer*V);
+    return funcGH;
   }
   else
   {
@@ -325,9 +440,102 @@ REBO::G(AtomsPair& ij, AtomsPair& ik, const Float V)
   }
 }
 
+void
+REBO::fillBonds(AtomsArray& gl)
+{
+  bonds.resize(nl.indices.size());
+
+#ifdef MDTK_OPENMP
+#pragma omp parallel for num_threads(forceThreads()) schedule(static,FORCE_THREADS_CHUNK)
+#endif
+  for(int i = 0; i < int(gl.size()); i++)
+  {
+    Atom &atom_i = gl[i];
+    NeighbourRefs nli = NL(atom_i);
+    for(size_t k = 0; k < nli.size(); k++)
+    {
+      Atom &atom_k = *nli[k];
+      AtomsPair ik(atom_i,atom_k,R(0,atom_i,atom_k),R(1,atom_i,atom_k));
+      Bond& b = bonds[bondIndex(atom_i,k)];
+      b.geometry = ik.geometry();
+      b.inCutoff = (ik.rv.module_squared() <= SQR(R(1,atom_i,atom_k)));
+    }
+  }
+}
+
+bool
+REBO::findBond(Atom& atom_i, Atom& atom_j, size_t& k)
+{
+  NeighbourRefs nli = NL(atom_i);
+  for(k = 0; k < nli.size(); k++)
+    if (nli[k] == &atom_j)
+      return true;
+  return false;
+}
+
+void
+REBO::fillDihedrals(AtomsArray& gl)
+{
+  dihedralRows.resize(gl.size());
+
+#ifdef MDTK_OPENMP
+#pragma omp parallel for num_threads(forceThreads()) schedule(static,FORCE_THREADS_CHUNK)
+#endif
+  for(int i = 0; i < int(gl.size()); i++)
+  {
+    Atom &atom_i = gl[i];
+    std::vector<Dihedral>& row = dihedralRows[i];
+    row.clear();
+    NeighbourRefs nli = NL(atom_i);
+    for(size_t j = 0; j < nli.size(); j++)
+    {
+      Atom &atom_j = *nli[j];
+      Bond& b = bonds[bondIndex(atom_i,j)];
+      b.firstDihedral = row.size();
+      b.dihedralCount = 0;
+      if (atom_i.globalIndex > atom_j.globalIndex || !b.inCutoff) continue;
+      if (atom_i.ID != C_EL || atom_j.ID != C_EL) continue;
+
+      AtomsPair ij(bond(atom_i,j,atom_j));
+      NeighbourRefs nlj = NL(atom_j);
+      for(size_t k = 0; k < nli.size(); k++)
+      {
+        Atom &atom_k = *nli[k];
+        if (&atom_k == &atom_j || !bonded(atom_i,k)) continue;
+        AtomsPair ik(reversedBond(atom_i,k,atom_k));
+        if (fabs(SinTheta(ij,ik))<0.1) continue;
+        for(size_t l = 0; l < nlj.size(); l++)
+        {
+          Atom &atom_l = *nlj[l];
+          if (&atom_l == &atom_i || &atom_l == &atom_k) continue;
+          if (!bonded(atom_j,l)) continue;
+          AtomsPair jl(reversedBond(atom_j,l,atom_l));
+          if (fabs(SinTheta(ij,jl))<0.1) continue;
+          Dihedral d;
+          d.k = k;
+          d.l = l;
+          row.push_back(d);
+        }
+      }
+      b.dihedralCount = row.size()-b.firstDihedral;
+    }
+  }
+}
+
+void
+REBO::fillTables(AtomsArray& gl)
+{
+  fillBonds(gl);
+  fillDihedrals(gl);
+  tablesEpoch++;
+  tablesAtoms = &gl;
+}
+
 void
 REBO::countNeighbours(AtomsArray& gl)
 {
+  fillTables(gl);
+
   Nts.clear();
   Nts.resize(gl.size());
   Nts2touch.clear();
@@ -335,68 +543,92 @@ REBO::countNeighbours(AtomsArray& gl)
 
   NCs.clear();
   NCs.resize(gl.size());
-  NCs2touch.resize(gl.size());
   NCs2touch.clear();
+  NCs2touch.resize(gl.size());
 
   NHs.clear();
   NHs.resize(gl.size());
   NHs2touch.clear();
   NHs2touch.resize(gl.size());
 
-  for(size_t i = 0; i < gl.size(); i++)
+#ifdef MDTK_OPENMP
+#pragma omp parallel for num_threads(forceThreads()) schedule(static,FORCE_THREADS_CHUNK)
+#endif
+  for(int i = 0; i < int(gl.size()); i++)
   {
     Atom &atom_i = gl[i];
     if (!isHandled(atom_i)) continue;
-    AtomRefsContainer& nli = NL(atom_i);
+    NeighbourRefs nli = NL(atom_i);
     for(size_t k = 0; k < nli.size(); k++)
     {
       Atom &atom_k = *nli[k];
 
-      Float fval = 0.0;
-      bool  touchNeeded = false;
-
-      Float r = depos(atom_i,atom_k).module();
-      Float R2 = R(1,atom_i,atom_k);
-      if (r>R2)
+      size_t b = bondIndex(atom_i,k);
+      Float r = bonds[b].geometry.r;
+      if (r>R(1,atom_i,atom_k))
         continue;
-      else
-      {
-        Float R1=R(0,atom_i,atom_k);
-        if (r<R1)
-          fval = 1.0;
-        else
-        {
-          touchNeeded = true;
-          fval = (1.0+cos(M_PI*(r-R1)/(R2-R1)))/2.0;
-        }
-      }
+      Float fval = bonds[b].geometry.f;
+      bool  touchNeeded = !(r<R(0,atom_i,atom_k));
 
       {
         Nts[i] += fval;
         if (touchNeeded)
-          Nts2touch[i].push_back(&atom_k);
+          Nts2touch[i].push_back(b);
       }
       if (atom_k.ID == H_EL)
       {
         NHs[i] += fval;
         if (touchNeeded)
-          NHs2touch[i].push_back(&atom_k);
+          NHs2touch[i].push_back(b);
       }
       if (atom_k.ID == C_EL)
       {
         NCs[i] += fval;
         if (touchNeeded)
-          NCs2touch[i].push_back(&atom_k);
+          NCs2touch[i].push_back(b);
       }
     }
   }
+
+  bondOrderSlots.assign(bonds.size(),-1);
+  bondOrderRows.resize(forceThreads());
+  for(size_t t = 0; t < bondOrderRows.size(); t++)
+    bondOrderRows[t].clear();
+
+  NconjSums.assign(gl.size(),0.0);
+  NconjTerms.assign(bonds.size(),0.0);
+  NconjSps.resize(bonds.size());
+  NconjdSps.resize(bonds.size());
+
+#ifdef MDTK_OPENMP
+#pragma omp parallel for num_threads(forceThreads()) schedule(static,FORCE_THREADS_CHUNK)
+#endif
+  for(int i = 0; i < int(gl.size()); i++)
+  {
+    Atom &atom_i = gl[i];
+    if (!isHandled(atom_i)) continue;
+    NeighbourRefs nli = NL(atom_i);
+    for(size_t k = 0; k < nli.size(); k++)
+    {
+      Atom &atom_k = *nli[k];
+      if (atom_k.ID != C_EL || !bonded(atom_i,k)) continue;
+
+      size_t b = bondIndex(atom_i,k);
+      AtomsPair ki(reversedBond(atom_i,k,atom_k));
+      Float N = Nt(ki);
+      NconjSps[b] = Sprime(N,Ntot_[0],Ntot_[1]);
+      NconjdSps[b] = dSprime(N,Ntot_[0],Ntot_[1]);
+      NconjTerms[b] = ki.f()*NconjSps[b];
+      NconjSums[i] += NconjTerms[b];
+    }
+  }
 }
 
 inline
 bool
 REBO::areNeighbours(Atom &atom_i, Atom &atom_j)
 {
-  AtomRefsContainer& nli = NL(atom_i);
+  NeighbourRefs nli = NL(atom_i);
   for(size_t k = 0; k < nli.size(); k++)
   {
     Atom &atom_k = *nli[k];
@@ -408,16 +640,19 @@ REBO::areNeighbours(Atom &atom_i, Atom &atom_j)
 
 inline
 void
-REBO::dfThem(const std::vector<std::vector<Atom*> >& patoms, AtomsPair& ij, const Float V)
+REBO::dfThem(const std::vector<std::vector<size_t> >& pbonds, AtomsPair& ij, const Float V)
 {
   if (V == 0.0) return;
-  const std::vector<Atom*>& they = patoms[ij.atom1.globalIndex];
+  const std::vector<size_t>& they = pbonds[ij.atom1.globalIndex];
   for(size_t k = 0; k < they.size(); k++)
-    if (they[k] != &ij.atom2)
+  {
+    Atom& atom_k = (*nl.atoms)[nl.indices[they[k]]];
+    if (&atom_k != &ij.atom2)
     {
-      AtomsPair ik(ij.atom1,*they[k],R(0,ij.atom1,*they[k]),R(1,ij.atom1,*they[k]));
+      AtomsPair ik(ij.atom1,atom_k,bonds[they[k]].geometry);
       ik.f(V);
     }
+  }
 }
 
 Float
@@ -537,90 +772,53 @@ REBO::dF(Float x) const
   }
 }
 
+/*
+  The sum of f_ik*S'(N_k) over the carbon neighbours k of atom1 but
+  atom2. Every term depends on the bond ik only, so countNeighbours
+  keeps the terms and their sum over all the neighbours. If atom2 has a
+  term of its own the cached terms are summed again without it, rather
+  than subtracted, so that integer sums stay exact at the spline knots.
+*/
 Float
 REBO::NconjSum1(AtomsPair& ij, const Float V)
 {
-  Float sum1 = 0.0;
-  AtomRefsContainer& nli = NL(ij.atom1);
-  for(size_t k = 0; k < nli.size(); k++)
+  size_t i = ij.atom1.globalIndex;
+  Float sum1 = NconjSums[i];
+  if (ij.atom2.ID == C_EL && ij.rv.module_squared() <= SQR(R(1,ij)))
   {
-    Atom& atom_k = *(nli[k]);
-    if (&atom_k != &ij.atom2 && atom_k.ID == C_EL)
-    {
-      if (!probablyAreNeighbours(ij.atom1,atom_k)) continue;
-//      AtomsPair ik(ij.atom1,atom_k,R(0,ij.atom1,atom_k),R(1,ij.atom1,atom_k));
-      AtomsPair ik(atom_k,ij.atom1,R(0,ij.atom1,atom_k),R(1,ij.atom1,atom_k));
-      Float f_ik = ik.f();
-
-      Float N   = Nt(ik);
-      Float Nt1 = Ntot_[0];
-      Float Nt2 = Ntot_[1];
-
-      Float Sp = Sprime(N,Nt1,Nt2);
-
-      if (V != 0.0)
-      {
-        ik.f(Sp*V);
-        Nt_donly(ik,f_ik*dSprime(N,Nt1,Nt2)*V);
-      }
-
-      sum1 += f_ik*Sp;
-    }
+    sum1 = 0.0;
+    for(size_t b = nl.offsets[i]; b < nl.offsets[i+1]; b++)
+      if (nl.indices[b] != ij.atom2.globalIndex)
+        sum1 += NconjTerms[b];
   }
 
-  return sum1;
-}
-
-Float
-REBO::NconjSum2(AtomsPair& ij, const Float V)
-{
-  Float sum2 = 0.0;
-  AtomRefsContainer& nlj = NL(ij.atom2);
-  for(size_t l = 0; l < nlj.size(); l++)
+  if (V != 0.0)
   {
-    Atom& atom_l = *(nlj[l]);
-    if (&atom_l != &ij.atom1 && atom_l.ID == C_EL)
+    NeighbourRefs nli = NL(ij.atom1);
+    for(size_t k = 0; k < nli.size(); k++)
     {
-      if (!probablyAreNeighbours(ij.atom2,atom_l)) continue;
-//      AtomsPair jl(ij.atom2,atom_l,R(0,ij.atom2,atom_l),R(1,ij.atom2,atom_l));
-      AtomsPair jl(atom_l,ij.atom2,R(0,ij.atom2,atom_l),R(1,ij.atom2,atom_l));
-      Float f_jl = jl.f();
-
-      Float N   = Nt(jl);
-      Float Nt1 = Ntot_[0];
-      Float Nt2 = Ntot_[1];
-
-      Float Sp = Sprime(N,Nt1,Nt2);
-
-      if (V != 0.0)
+      Atom& atom_k = *(nli[k]);
+      if (&atom_k != &ij.atom2 && atom_k.ID == C_EL)
       {
-        jl.f(Sp*V);
-        Nt_donly(jl,f_jl*dSprime(N,Nt1,Nt2)*V);
-      }
+        if (!bonded(ij.atom1,k)) continue;
+        size_t b = bondIndex(ij.atom1,k);
+        AtomsPair ik(reversedBond(ij.atom1,k,atom_k));
+        Float f_ik = ik.f();
 
-      sum2 += f_jl*Sp;
+        ik.f(NconjSps[b]*V);
+        Nt_donly(ik,f_ik*NconjdSps[b]*V);
+      }
     }
   }
 
-  return sum2;
+  return sum1;
 }
 
 Float
-REBO::Nconj(AtomsPair& ij, const Float V)
+REBO::NconjSum2(AtomsPair& ij, const Float V)
 {
-  Float Nconj_ij = 1.0;
-
-  Float sum1 = NconjSum1(ij);
-  if (V != 0.0 && sum1 != 0.0)
-    NconjSum1(ij,2.0*sum1*V);
-  Nconj_ij += SQR(sum1);
-
-  Float sum2 = NconjSum2(ij);
-  if (V != 0.0 && sum2 != 0.0)
-    NconjSum2(ij,2.0*sum2*V);
-  Nconj_ij += SQR(sum2);
-
-  return Nconj_ij;
+  AtomsPair ji(-ij);
+  return NconjSum1(ji,V);
 }
 
 inline
@@ -633,124 +831,73 @@ RETURN_REBO_0;
   {
     Float NHVar = NH(ij);
     Float NCVar = NC(ij);
-    Float Val = P_CC_num(NHVar,NCVar);
-    if (V != 0.0)
-    {
-      NH_donly(ij,P_CC_dH_num(NHVar,NCVar)*V);
-      NC_donly(ij,P_CC_dC_num(NHVar,NCVar)*V);
-    }
+    if (V == 0.0)
+      return P_CC_num(NHVar,NCVar);
+    Float dH, dC;
+    Float Val = P_CC_num(NHVar,NCVar,dH,dC);
+    NH_donly(ij,dH*V);
+    NC_donly(ij,dC*V);
     return Val;
   }
   else if (ij.atom1.ID == C_EL && ij.atom2.ID == H_EL)
   {
     Float NHVar = NH(ij);
     Float NCVar = NC(ij);
-    Float Val = P_CH_num(NHVar,NCVar);
-    if (V != 0.0)
-    {
-      NH_donly(ij,P_CH_dH_num(NHVar,NCVar)*V);
-      NC_donly(ij,P_CH_dC_num(NHVar,NCVar)*V);
-    }
+    if (V == 0.0)
+      return P_CH_num(NHVar,NCVar);
+    Float dH, dC;
+    Float Val = P_CH_num(NHVar,NCVar,dH,dC);
+    NH_donly(ij,dH*V);
+    NC_donly(ij,dC*V);
     return Val;
   }
   else return 0.0;
 }
 
-inline
+/*
+  The dihedrals of a bond in the table are taken from it, those of the
+  other pairs AIREBO asks about are found by walking the neighbours.
+*/
 Float
-REBO::pi_rc(AtomsPair& ij, const Float V)
+REBO::pi_dh_sum(AtomsPair& ij, const Float V)
 {
-  RETURN_REBO_0;
-
-  AtomsPair ji(-ij);
+RETURN_REBO_0;
 
-  if (ij.atom1.ID == C_EL && ij.atom2.ID == C_EL)
-  {
-    Float Nti = Nt(ij);
-    Float Ntj = Nt(ji);
-    Float Nconj_ij = Nconj(ij);
-    Float Val = pi_rc_CC_num(Nti,Ntj,Nconj_ij);
-    if (V != 0.0)
-    {
-      Nt_donly(ij,pi_rc_CC_dNt_i_num(Nti,Ntj,Nconj_ij)*V);
-      Nt_donly(ji,pi_rc_CC_dNt_j_num(Nti,Ntj,Nconj_ij)*V);
-      Nconj(ij,pi_rc_CC_dNconj_num(Nti,Ntj,Nconj_ij)*V);
-    }
-    return Val;
-  }
-  if (ij.atom1.ID == C_EL && ij.atom2.ID == H_EL)
-  {
-    Float Nti = Nt(ij);
-    Float Ntj = Nt(ji);
-    Float Nconj_ij = Nconj(ij);
-    Float Val = pi_rc_CH_num(Nti,Ntj,Nconj_ij);
-    if (V != 0.0)
-    {
-      Nt_donly(ij,pi_rc_CH_dNt_i_num(Nti,Ntj,Nconj_ij)*V);
-      Nt_donly(ji,pi_rc_CH_dNt_j_num(Nti,Ntj,Nconj_ij)*V);
-      Nconj(ij,pi_rc_CH_dNconj_num(Nti,Ntj,Nconj_ij)*V);
-    }
-    return Val;
-  }
-  if (ij.atom1.ID == H_EL && ij.atom2.ID == C_EL)
-  {
-    return pi_rc(ji,V);
-  }
-  if (ij.atom1.ID == H_EL && ij.atom2.ID == H_EL)
+  Float  temp_sum = 0.0;
+  NeighbourRefs nli = NL(ij.atom1);
+  NeighbourRefs nlj = NL(ij.atom2);
+  size_t jj;
+  if (ij.atom1.globalIndex < ij.atom2.globalIndex &&
+      findBond(ij.atom1,ij.atom2,jj) && bonded(ij.atom1,jj))
   {
-    Float Nti = Nt(ij);
-    Float Ntj = Nt(ji);
-    Float Nconj_ij = Nconj(ij);
-    Float Val = pi_rc_HH_num(Nti,Ntj,Nconj_ij);
-    if (V != 0.0)
+    const Bond& b = bonds[bondIndex(ij.atom1,jj)];
+    const std::vector<Dihedral>& row = dihedralRows[ij.atom1.globalIndex];
+    for(size_t d = b.firstDihedral; d < b.firstDihedral+b.dihedralCount; d++)
     {
-      Nt_donly(ij,pi_rc_HH_dNt_i_num(Nti,Ntj,Nconj_ij)*V);
-      Nt_donly(ji,pi_rc_HH_dNt_j_num(Nti,Ntj,Nconj_ij)*V);
-      Nconj(ij,pi_rc_HH_dNconj_num(Nti,Ntj,Nconj_ij)*V);
+      AtomsPair ik(reversedBond(ij.atom1,row[d].k,*nli[row[d].k]));
+      AtomsPair jl(reversedBond(ij.atom2,row[d].l,*nlj[row[d].l]));
+      temp_sum += pi_dh_term(ij,ik,jl,V);
     }
-    return Val;
+    return temp_sum;
   }
-  return 0.0;
-}
-
-Float
-REBO::pi_dh_sum(AtomsPair& ij, const Float V)
-{
-RETURN_REBO_0;
 
-  Float  temp_sum = 0.0;
-  AtomRefsContainer& nli = NL(ij.atom1);
   for(size_t k = 0; k < nli.size(); k++)
   {
     Atom& atom_k = *(nli[k]);
     if (&atom_k == &ij.atom2 /* && atom_k.ID == C_EL*/) continue;
-    if (!probablyAreNeighbours(ij.atom1,atom_k)) continue;
-    AtomRefsContainer& nlj = NL(ij.atom2);
+    if (!bonded(ij.atom1,k)) continue;
     for(size_t l = 0; l < nlj.size(); l++)
     {
       Atom& atom_l = *(nlj[l]);
       if (&atom_l == &ij.atom1 /* && atom_l.ID == C_EL*/) continue;
-      if (!probablyAreNeighbours(ij.atom2,atom_l)) continue;
+      if (!bonded(ij.atom2,l)) continue;
       if (&atom_k != &atom_l) // otherwise cos=1 -> temp_sum=0
       {
-        AtomsPair ik(atom_k,ij.atom1,R(0,ij.atom1,atom_k),R(1,ij.atom1,atom_k));
+        AtomsPair ik(reversedBond(ij.atom1,k,atom_k));
         if (fabs(SinTheta(ij,ik))<0.1) continue;
-        AtomsPair ki(-ik);
-        Float f_ik = fprime(ik);
-        AtomsPair jl(atom_l,ij.atom2,R(0,ij.atom2,atom_l),R(1,ij.atom2,atom_l));
+        AtomsPair jl(reversedBond(ij.atom2,l,atom_l));
         if (fabs(SinTheta(ij,jl))<0.1) continue;
-        AtomsPair lj(-jl);
-        Float f_jl = fprime(jl);
-        Float CosDh = - CosDihedral(ij,ki,lj);
-
-        if (V != 0)
-        {
-          CosDihedral(ij,ki,lj,+1.0*2*CosDh*f_ik*f_jl*V);
-          fprime(ik,(1.0-SQR(CosDh))*f_jl*V);
-          fprime(jl,(1.0-SQR(CosDh))*f_ik*V);
-        }
-
-        temp_sum += (1.0-SQR(CosDh))*f_ik*f_jl;
+        temp_sum += pi_dh_term(ij,ik,jl,V);
       }
     }
   }
@@ -758,59 +905,24 @@ RETURN_REBO_0;
   return temp_sum;
 }
 
+inline
 Float
-REBO::pi_dh_Tij(AtomsPair& ij, const Float V)
-{
-RETURN_REBO_0;
-
-  AtomsPair ji(-ij);
-
-  if (ij.atom1.ID == H_EL || ij.atom2.ID == H_EL) return 0.0;
-
-  Float Nti = Nt(ij);
-  Float Ntj = Nt(ji);
-  Float Nconj_ij = Nconj(ij);
-  Float Tij_num_val = Tij_num(Nti,Ntj,Nconj_ij);
-  if (V != 0.0)
-  {
-    Float Tij_dNt_i_num_val = Tij_dNt_i_num (Nti,Ntj,Nconj_ij);
-    Float Tij_dNt_j_num_val = Tij_dNt_j_num (Nti,Ntj,Nconj_ij);
-    Float Tij_dNconj_num_val = Tij_dNconj_num(Nti,Ntj,Nconj_ij);
-
-    if (
-      Tij_num_val == 0.0 &&
-      Tij_dNt_i_num_val == 0.0 &&
-      Tij_dNt_j_num_val == 0.0 &&
-      Tij_dNconj_num_val == 0.0
-      ) return 0.0;
-
-    if (Tij_dNt_i_num_val != 0.0)
-      Nt_donly(ij,Tij_dNt_i_num_val*V);
-    if (Tij_dNt_j_num_val != 0.0)
-      Nt_donly(ji,Tij_dNt_j_num_val*V);
-    if (Tij_dNconj_num_val != 0.0)
-      Nconj(ij,Tij_dNconj_num_val*V);
-  }
-
-  return Tij_num_val;
-}
-
-Float
-REBO::pi_dh(AtomsPair& ij, const Float V)
+REBO::pi_dh_term(AtomsPair& ij, AtomsPair& ik, AtomsPair& jl, const Float V)
 {
-  Float  TijVal = pi_dh_Tij(ij);
-  if (TijVal == 0.0) return 0.0;
-
-  Float temp_sum = pi_dh_sum(ij);
+  AtomsPair ki(-ik);
+  Float f_ik = fprime(ik);
+  AtomsPair lj(-jl);
+  Float f_jl = fprime(jl);
+  Float CosDh = - CosDihedral(ij,ki,lj);
 
-  if (V != 0.0)
+  if (V != 0)
   {
-    if (temp_sum != 0.0)
-      pi_dh_Tij(ij,temp_sum*V);
-    pi_dh_sum(ij,TijVal*V);
+    CosDihedral(ij,ki,lj,+1.0*2*CosDh*f_ik*f_jl*V);
+    fprime(ik,(1.0-SQR(CosDh))*f_jl*V);
+    fprime(jl,(1.0-SQR(CosDh))*f_ik*V);
   }
 
-  return TijVal*temp_sum;
+  return (1.0-SQR(CosDh))*f_ik*f_jl;
 }
 
 REBO::REBO(ParamSet /*parSet*/):
@@ -824,12 +936,22 @@ REBO::REBO(ParamSet /*parSet*/):
   funcG_C2(),
   funcG_H(),
   func_Tij(),
+  bonds(),
+  dihedralRows(),
+  tablesEpoch(0),
+  tablesAtoms(NULL),
   Nts(),
   Nts2touch(),
   NCs(),
   NCs2touch(),
   NHs(),
-  NHs2touch()
+  NHs2touch(),
+  NconjSums(),
+  NconjTerms(),
+  NconjSps(),
+  NconjdSps(),
+  bondOrderSlots(),
+  bondOrderRows()
 {
 
   func_pi_rc_CC.init(0);
@@ -842,12 +964,18 @@ REBO::REBO(ParamSet /*parSet*/):
   
   func_Tij.init();
 
-  handledElements.insert(H_EL);
-  handledElements.insert(C_EL);
-  handledElementPairs.insert(std::make_pair(H_EL,C_EL));
-  handledElementPairs.insert(std::make_pair(C_EL,H_EL));
-  handledElementPairs.insert(std::make_pair(H_EL,H_EL));
-  handledElementPairs.insert(std::make_pair(C_EL,C_EL));
+  handleElement(H_EL);
+  handleElement(C_EL);
+  handleElementPair(H_EL,C_EL);
+  handleElementPair(C_EL,H_EL);
+  handleElementPair(H_EL,H_EL);
+  handleElementPair(C_EL,C_EL);
+
+  for(size_t i = 0; i < SPECIES_size; ++i)
+    e2i_[i] = 0;
+  e2i_[ElementIDtoSpecies(H_EL)] = H;
+  e2i_[ElementIDtoSpecies(C_EL)] = C;
+
   setupPotential1();
 
   nl.Rcutoff = getRcutoff();
@@ -49,6 +49,7 @@ namespace mdtk
 class REBO : public FManybody
 {
   friend class AIREBO;
+  friend class ETors;
 public:
   Float Sprime(Float arg, Float arg_min, Float arg_max) const;
   Float dSprime(Float arg, Float arg_min, Float arg_max) const;
@@ -60,8 +61,24 @@ public:
 
   Float VA(AtomsPair& ij, const Float V = 0.0);
 protected:
+/*
+  What the adjoint pass of the bond order needs from its forward pass.
+*/
+  struct BondOrder
+  {
+    Float value;
+    Float D_ij, D_ji;
+    Float Nti, Ntj, Nconj;
+    Float sum1, sum2;
+    Float TijVal, dihedralSum;
+// gradients of pi_rc and Tij over (Nti,Ntj,Nconj)
+    Float dPi_rc[3], dTij[3];
+    bool swapped;
+  };
+  void bondOrder(AtomsPair& ij, BondOrder& bo, const Float V = 0.0);
+  void bondOrderDerivatives(AtomsPair& ij, const BondOrder& bo,
+                            const Float V, bool pushDihedral);
   Float Baver(AtomsPair& ij, const Float V = 0.0);
-  Float p_sigma_pi(AtomsPair& ij, const Float V = 0.0);
   Float D(AtomsPair& ij, const Float V = 0.0);
   Float ExpTerm(AtomsPair& ij, AtomsPair& ik, const Float V = 0.0);
   Float G(AtomsPair& ij, AtomsPair& ik, const Float V = 0.0);
@@ -76,72 +93,54 @@ protected:
 
   Float NconjSum1(AtomsPair& ij, const Float V = 0.0);
   Float NconjSum2(AtomsPair& ij, const Float V = 0.0);
-  Float Nconj(AtomsPair& ij, const Float V = 0.0);
   Float F(Float x) const;
   Float dF(Float x) const;
 
   Float P_CC_num(Float a1, Float a2) const
     { return funcP_CC(a1,a2); }
-  Float P_CC_dH_num(Float a1, Float a2) const
-    { return funcP_CC.dH(a1,a2); }
-  Float P_CC_dC_num(Float a1, Float a2) const
-    { return funcP_CC.dC(a1,a2); }
+  Float P_CC_num(Float a1, Float a2, Float& dH, Float& dC) const
+    { return funcP_CC(a1,a2,dH,dC); }
 
   Float P_CH_num(Float a1, Float a2) const
     { return funcP_CH(a1,a2); }
-  Float P_CH_dH_num(Float a1, Float a2) const
-    { return funcP_CH.dH(a1,a2); }
-  Float P_CH_dC_num(Float a1, Float a2) const
-    { return funcP_CH.dC(a1,a2); }
+  Float P_CH_num(Float a1, Float a2, Float& dH, Float& dC) const
+    { return funcP_CH(a1,a2,dH,dC); }
 
   Float P(AtomsPair& ij, const Float V = 0.0);
 
   Float pi_rc_CC_num(Float a1, Float a2, Float a3) const
     { return func_pi_rc_CC(a1,a2,a3); }
-  Float pi_rc_CC_dNconj_num(Float a1, Float a2, Float a3) const
-    { return func_pi_rc_CC.dk(a1,a2,a3); }
-  Float pi_rc_CC_dNt_i_num(Float a1, Float a2, Float a3) const
-    { return func_pi_rc_CC.di(a1,a2,a3); }
-  Float pi_rc_CC_dNt_j_num(Float a1, Float a2, Float a3) const
-    { return func_pi_rc_CC.dj(a1,a2,a3); }
+  Float pi_rc_CC_num(Float a1, Float a2, Float a3,
+                     Float& dNt_i, Float& dNt_j, Float& dNconj) const
+    { return func_pi_rc_CC(a1,a2,a3,dNt_i,dNt_j,dNconj); }
 
   Float pi_rc_CH_num(Float a1, Float a2, Float a3) const
     { return func_pi_rc_CH(a1,a2,a3); }
-  Float pi_rc_CH_dNconj_num(Float a1, Float a2, Float a3) const
-    { return func_pi_rc_CH.dk(a1,a2,a3); }
-  Float pi_rc_CH_dNt_i_num(Float a1, Float a2, Float a3) const
-    { return func_pi_rc_CH.di(a1,a2,a3); }
-  Float pi_rc_CH_dNt_j_num(Float a1, Float a2, Float a3) const
-    { return func_pi_rc_CH.dj(a1,a2,a3); }
+  Float pi_rc_CH_num(Float a1, Float a2, Float a3,
+                     Float& dNt_i, Float& dNt_j, Float& dNconj) const
+    { return func_pi_rc_CH(a1,a2,a3,dNt_i,dNt_j,dNconj); }
 
   Float pi_rc_HH_num(Float a1, Float a2, Float a3) const
     { return func_pi_rc_HH(a1,a2,a3); }
-  Float pi_rc_HH_dNconj_num(Float a1, Float a2, Float a3) const
-    { return func_pi_rc_HH.dk(a1,a2,a3); }
-  Float pi_rc_HH_dNt_i_num(Float a1, Float a2, Float a3) const
-    { return func_pi_rc_HH.di(a1,a2,a3); }
-  Float pi_rc_HH_dNt_j_num(Float a1, Float a2, Float a3) const
-    { return func_pi_rc_HH.dj(a1,a2,a3); }
-
-  Float pi_rc(AtomsPair& ij, const Float V = 0.0);
+  Float pi_rc_HH_num(Float a1, Float a2, Float a3,
+                     Float& dNt_i, Float& dNt_j, Float& dNconj) const
+    { return func_pi_rc_HH(a1,a2,a3,dNt_i,dNt_j,dNconj); }
+
 public:
-  Float pi_dh_Tij(AtomsPair& ij, const Float V = 0.0);
   Float pi_dh_sum(AtomsPair& ij, const Float V = 0.0);
-  Float pi_dh(AtomsPair& ij, const Float V = 0.0);
+  Float pi_dh_term(AtomsPair& ij, AtomsPair& ik, AtomsPair& jl, const Float V);
 
   Float Tij_num(Float a1, Float a2, Float a3) const
     { return func_Tij(a1,a2,a3); }
-  Float Tij_dNconj_num(Float a1, Float a2, Float a3) const
-    { return func_Tij.dk(a1,a2,a3); }
-  Float Tij_dNt_i_num(Float a1, Float a2, Float a3) const
-    { return func_Tij.di(a1,a2,a3); }
-  Float Tij_dNt_j_num(Float a1, Float a2, Float a3) const
-    { return func_Tij.dj(a1,a2,a3); }
+  Float Tij_num(Float a1, Float a2, Float a3,
+                Float& dNt_i, Float& dNt_j, Float& dNconj) const
+    { return func_Tij(a1,a2,a3,dNt_i,dNt_j,dNconj); }
 
 public:
   enum ParamSet{POTENTIAL1,POTENTIAL2} /*paramSet*/;  
 
   virtual Float operator()(AtomsArray&);
+  void accumulateEnergy(AtomsArray& gl, size_t i, Float& Ei);
 
   REBO(ParamSet /*parSet*/ = POTENTIAL1);
   Float getRcutoff() const {return      max3(R_[C][C][1],R_[C][H][1],R_[H][H][1]);}
@@ -176,14 +175,10 @@ protected:
 
   void setupPotential1();
 
+  int e2i_[SPECIES_size];
   size_t e2i(const Atom &atom) const
   {
-    switch (atom.ID)
-    {
-      case H_EL : return H; break;
-      case C_EL : return C; break;
-      default : throw Exception("e2i() : unknown element");
-    };
+    return e2i_[atom.species];
   }
 
   Float Q(const AtomsPair& ij) const
@@ -247,13 +242,86 @@ public:
     FManybody::LoadFromStream(is,smode);
   }
 
+/*
+  Bond table, parallel to the neighbour list: the pair of atom i with
+  its k-th neighbour is bonds[nl.offsets[i]+k]. It is filled once per
+  evaluation, and the terms build their AtomsPairs from it instead of
+  from the coordinates.
+*/
+  struct Bond
+  {
+    PairGeometry geometry;
+    bool inCutoff;
+    uint32_t firstDihedral;
+    uint32_t dihedralCount;
+  };
+  std::vector<Bond> bonds;
+  void fillBonds(AtomsArray& gl);
+  size_t bondIndex(const Atom& atom_i, size_t k) const
+    {
+      return nl.offsets[atom_i.globalIndex]+k;
+    }
+  bool bonded(const Atom& atom_i, size_t k) const
+    {
+      return bonds[bondIndex(atom_i,k)].inCutoff;
+    }
+  AtomsPair bond(Atom& atom_i, size_t k, Atom& atom_k) const
+    {
+      return AtomsPair(atom_i,atom_k,bonds[bondIndex(atom_i,k)].geometry);
+    }
+  AtomsPair reversedBond(Atom& atom_i, size_t k, Atom& atom_k) const
+    {
+      return AtomsPair(atom_k,atom_i,bonds[bondIndex(atom_i,k)].geometry,true);
+    }
+  bool findBond(Atom& atom_i, Atom& atom_j, size_t& k);
+
+/*
+  Dihedral table: for every C-C bond i-j with i < j, the bonded
+  neighbours k of i and l of j, k != l, that span a dihedral k-i-j-l
+  with neither bond angle too flat. It is kept in the row of atom i as
+  positions in the neighbour rows of i and j, and each bond knows its
+  range of the row. Filled with the bond table.
+*/
+  struct Dihedral
+  {
+    uint32_t k;
+    uint32_t l;
+  };
+  std::vector<std::vector<Dihedral> > dihedralRows;
+  void fillDihedrals(AtomsArray& gl);
+/*
+  Fills the bond and dihedral tables for gl. tablesEpoch counts the
+  fillings, so that ETors and AIREBO can tell tables of the current
+  evaluation from stale ones; 0 until the first.
+*/
+  void fillTables(AtomsArray& gl);
+  unsigned long tablesEpoch;
+  const AtomsArray* tablesAtoms;
+
   std::vector<Float> Nts;
-  std::vector<std::vector<Atom*> > Nts2touch;
+  std::vector<std::vector<size_t> > Nts2touch;
   std::vector<Float> NCs;
-  std::vector<std::vector<Atom*> > NCs2touch;
+  std::vector<std::vector<size_t> > NCs2touch;
   std::vector<Float> NHs;
-  std::vector<std::vector<Atom*> > NHs2touch;
-  void dfThem(const std::vector<std::vector<Atom*> >& patoms, AtomsPair& ij, const Float V);
+  std::vector<std::vector<size_t> > NHs2touch;
+/*
+  Per atom, the sum of f_ik*S'(N_k) over its carbon neighbours k; per
+  bond, its term (zero for the other neighbours), S'(N_k) and dS'(N_k).
+*/
+  std::vector<Float> NconjSums;
+  std::vector<Float> NconjTerms;
+  std::vector<Float> NconjSps;
+  std::vector<Float> NconjdSps;
+/*
+  Bond orders of the C-C bonds within the switching region, published
+  by the threads that evaluated them for AIREBO to reuse. The slot of
+  a bond is -1, or t+threads*n for the n-th state of thread t.
+*/
+  std::vector<int> bondOrderSlots;
+  std::vector<std::vector<BondOrder> > bondOrderRows;
+  void publishBondOrder(size_t b, AtomsPair& ij, const BondOrder& bo);
+  const BondOrder* publishedBondOrder(Atom& atom_i, Atom& atom_j);
+  void dfThem(const std::vector<std::vector<size_t> >& pbonds, AtomsPair& ij, const Float V);
   bool areNeighbours(Atom &atom_i, Atom &atom_j);
   void countNeighbours(AtomsArray& gl);
 };
@@ -58,6 +58,8 @@ FuncG_C1::init()
   for(int i = 0; i < splineCount; i++)
     spline[i] = Spline5n(x[i  ],y[i  ],dy[i  ],d2y[i  ],
                          x[i+1],y[i+1],dy[i+1],d2y[i+1]);
+
+  indexPieces();
 }  
 
 void
@@ -79,6 +81,8 @@ FuncG_C2::init()
   for(int i = 0; i < splineCount; i++)
     spline[i] = Spline5n(x[i  ],y[i  ],dy[i  ],d2y[i  ],
                          x[i+1],y[i+1],dy[i+1],d2y[i+1]);
+
+  indexPieces();
 }  
 
 void
@@ -99,6 +103,8 @@ FuncG_H::init()
   for(int i = 0; i < splineCount; i++)
     spline[i] = Spline5n(x[i  ],y[i  ],dy[i  ],d2y[i  ],
                          x[i+1],y[i+1],dy[i+1],d2y[i+1]);
+
+  indexPieces();
 }  
 
 void
@@ -327,7 +333,8 @@ FuncP_CH::FuncP_CH(int paramSet)
         DFCCDI[i][j][k] = 0.0;\
         DFCCDJ[i][j][k] = 0.0;\
         DFCCDK[i][j][k] = 0.0;\
-      }  \\
+      }  \
+\
 
 
 #define pi_rc_c1_COMMON_INC \
@@ -388,7 +395,8 @@ FuncP_CH::FuncP_CH(int paramSet)
       dvdz[1][1][1] = DFCCDK[i+1][j+1][k+1];\
 \
       spline[i][j][k] = Spline3D(x,y,z,v,dvdx,dvdy,dvdz);\
-    }  \\
+    }  \
+\
 
 
 void
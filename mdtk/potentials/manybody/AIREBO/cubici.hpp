@@ -44,10 +44,15 @@ class FuncG
 protected:
   Spline5n spline[100];
   int      splineCount;
+// upper bounds of the spline pieces, sorted, for the binary search
+  Float    x2_[100];
+  void indexPieces();
+  int piece(Float CosT) const;
 public:
   FuncG(){;};
   virtual ~FuncG(){;};
   Float operator()(Float CosT) const;  
+  Float operator()(Float CosT, Float& dCosT) const;
   Float dCosT(Float CosT) const;  
 
   virtual void init() = 0;
@@ -83,27 +88,59 @@ public:
    }  
 };
 
+inline
+void
+FuncG::indexPieces()
+{
+  for(int i = 0; i < splineCount; i++)
+  {
+    x2_[i] = spline[i].x2();
+    if (i > 0)
+      REQUIRE(x2_[i] > x2_[i-1]);
+  }
+}
+
+/*
+  Index of the first piece whose upper bound is not below CosT, what the
+  linear scan over the pieces used to find.
+*/
+inline
+int
+FuncG::piece(Float CosT) const
+{
+  REQUIREM(CosT>=-1.0 && CosT<=+1.0,"FuncG: CosT>=-1.0 && CosT<=+1.0");
+  int lo = 0;
+  int hi = splineCount-1;
+  while (lo < hi)
+  {
+    int mid = (lo+hi)/2;
+    if (CosT <= x2_[mid])
+      hi = mid;
+    else
+      lo = mid+1;
+  }
+  return lo;
+}
+
 inline
 Float
 FuncG::operator()(Float CosT) const
 {
-  REQUIREM(CosT>=-1.0 && CosT<=+1.0,"FuncG: CosT>=-1.0 && CosT<=+1.0");
-  int splineIndex;
-  for(splineIndex = 0; splineIndex < splineCount; splineIndex++)
-    if (CosT <= spline[splineIndex].x2()) break;
-  return spline[splineIndex].operator()(CosT);
+  return spline[piece(CosT)].operator()(CosT);
 }
-    
+
 inline
 Float
-FuncG::dCosT(Float CosT) const
+FuncG::operator()(Float CosT, Float& dCosT) const
 {
-  REQUIREM(CosT>=-1.0 && CosT<=+1.0,"FuncG: CosT>=-1.0 && CosT<=+1.0");
-  int splineIndex;
-  for(splineIndex = 0; splineIndex < splineCount; splineIndex++)
-    if (CosT <= spline[splineIndex].x2()) break;
+  return spline[piece(CosT)].operator()(CosT,dCosT);
+}
 
-  return spline[splineIndex].der(CosT);
+inline
+Float
+FuncG::dCosT(Float CosT) const
+{
+  return spline[piece(CosT)].der(CosT);
 }
 
 
@@ -120,6 +157,7 @@ public:
   FuncP_CC(int paramSet = 0);
   virtual ~FuncP_CC(){};
   Float operator()(Float h, Float c) const;  
+  Float operator()(Float h, Float c, Float& dh, Float& dc) const;
   Float dH(Float h, Float c) const;  
   Float dC(Float h, Float c) const;  
 };
@@ -135,6 +173,7 @@ public:
   FuncP_CH(int paramSet = 0);
   virtual ~FuncP_CH(){};
   Float operator()(Float h, Float c) const;  
+  Float operator()(Float h, Float c, Float& dh, Float& dc) const;
   Float dH(Float h, Float c) const;  
   Float dC(Float h, Float c) const;  
 };
@@ -158,6 +197,8 @@ public:
   virtual ~Func_pi_rc(){};
   virtual void init(int paramSet = 0) = 0;
   Float operator()(Float i, Float j, Float k) const;  
+  Float operator()(Float i, Float j, Float k,
+                   Float& di, Float& dj, Float& dk) const;
   Float di(Float i, Float j, Float k) const;  
   Float dj(Float i, Float j, Float k) const;  
   Float dk(Float i, Float j, Float k) const;  
@@ -219,6 +260,26 @@ FuncP_CC::operator()(Float h, Float c) const
   return spline[h_int][c_int].operator()(h,c);
 }
     
+inline
+Float
+FuncP_CC::operator()(Float h, Float c, Float& dh, Float& dc) const
+{
+  REQUIREM(h>=0 && c>=0,"H: h>=0 && c>=0");
+  dh = dc = 0.0;
+  if (h>=4 || c>=4) return 0.0;
+
+  int h_int = int(h);
+  int c_int = int(c);
+  if (Float(h_int) == h && Float(c_int) == c)
+  {
+    dh = dH_intarg[h_int][c_int];
+    dc = dC_intarg[h_int][c_int];
+    return intarg[h_int][c_int];
+  }
+
+  return spline[h_int][c_int].operator()(h,c,dh,dc);
+}
+
 inline
 Float
 FuncP_CC::dH(Float h, Float c) const
@@ -266,6 +327,26 @@ FuncP_CH::operator()(Float h, Float c) const
 }
 
     
+inline
+Float
+FuncP_CH::operator()(Float h, Float c, Float& dh, Float& dc) const
+{
+  REQUIREM(h>=0 && c>=0,"H: h>=0 && c>=0");
+  dh = dc = 0.0;
+  if (h>=4 || c>=4) return 0.0;
+
+  int h_int = int(h);
+  int c_int = int(c);
+  if (Float(h_int) == h && Float(c_int) == c)
+  {
+    dh = dH_intarg[h_int][c_int];
+    dc = dC_intarg[h_int][c_int];
+    return intarg[h_int][c_int];
+  }
+
+  return spline[h_int][c_int].operator()(h,c,dh,dc);
+}
+
 inline
 Float
 FuncP_CH::dH(Float h, Float c) const
@@ -315,6 +396,34 @@ Func_pi_rc::operator()(Float i, Float j, Float k) const
   return spline[i_int][j_int][k_int].operator()(i,j,k);
 }
 
+/*
+  The value and the gradient from a single cell lookup, the same as
+  operator(), di(), dj() and dk() called one by one.
+*/
+inline
+Float
+Func_pi_rc::operator()(Float i, Float j, Float k,
+                       Float& di, Float& dj, Float& dk) const
+{
+  REQUIREM(i>=0 && j>=0 && k>=1,"F: i>=0 && j>=0 && k>=1");
+  di = dj = dk = 0.0;
+  if (i>=i_size_pi_rc-1 || j>=j_size_pi_rc-1) return 0.0;
+  if (k > (k_size_pi_rc-1)) k = (k_size_pi_rc-1);
+
+  int i_int = int(i);
+  int j_int = int(j);
+  int k_int = int(k);
+  if (Float(i_int) == i && Float(j_int) == j && Float(k_int) == k)
+  {
+    di = di_intarg[i_int][j_int][k_int];
+    dj = dj_intarg[i_int][j_int][k_int];
+    dk = dk_intarg[i_int][j_int][k_int];
+    return intarg[i_int][j_int][k_int];
+  }
+
+  return spline[i_int][j_int][k_int].operator()(i,j,k,di,dj,dk);
+}
+
 inline
 Float
 Func_pi_rc::di(Float i, Float j, Float k) const
@@ -31,28 +31,63 @@ namespace mdtk
 Float
 Ackland::operator()(AtomsArray& gl)
 {
-  Float Ei = 0;
-  for(size_t ii = 0; ii < gl.size(); ii++)
+  fillDensities(gl);
+  return accumulateOverAtoms(*this,gl,&Ackland::accumulateEnergy);
+}
+
+void
+Ackland::accumulateEnergy(AtomsArray& gl, size_t ii, Float& Ei)
+{
+  Atom &atom_i = gl[ii];
+  if (isHandled(atom_i))
   {
-    Atom &atom_i = gl[ii];
-    if (isHandled(atom_i))
-    {
-      Ei += F(atom_i);
+    REQUIRE(rhos[ii] >= 0.0);
+    Ei += -sqrt(rhos[ii]);
 
-      for(size_t jj = 0; jj < NL(atom_i).size(); jj++)
+    NeighbourRefs nli = NL(atom_i);
+    for(size_t jj = 0; jj < nli.size(); jj++)
+    {
+      Atom &atom_j = *(nli[jj]);
+      if (atom_i.globalIndex > atom_j.globalIndex) continue;
+      if (&atom_i != &atom_j)
       {
-        Atom &atom_j = *(NL(atom_i)[jj]);
-        if (atom_i.globalIndex > atom_j.globalIndex) continue;
-        if (&atom_i != &atom_j)
-        {
-          AtomsPair ij(atom_i,atom_j,10.0*Ao,20.0*Ao);
-          Ei += Phi(ij);
-        }
+        if (!withinCutoff(atom_i,atom_j,cutoff_)) continue;
+        AtomsPair ij(atom_i,atom_j,10.0*Ao,20.0*Ao);
+        Ei += Phi(ij);
+        Float dF = dFs[ii]+dFs[atom_j.globalIndex];
+        if (dF != 0.0)
+          g(ij,dF);
       }
     }
   }
+}
 
-  return Ei;
+void
+Ackland::fillDensities(AtomsArray& gl)
+{
+  rhos.assign(gl.size(),0.0);
+  dFs.assign(gl.size(),0.0);
+
+#ifdef MDTK_OPENMP
+#pragma omp parallel for num_threads(forceThreads()) schedule(static,FORCE_THREADS_CHUNK)
+#endif
+  for(int i = 0; i < int(gl.size()); i++)
+  {
+    Atom &atom_i = gl[i];
+    if (!isHandled(atom_i)) continue;
+    Float rhovar = 0.0;
+    NeighbourRefs nli = NL(atom_i);
+    for(size_t j = 0; j < nli.size(); j++)
+    {
+      Atom& atom_j = *(nli[j]);
+      if (!withinCutoff(atom_i,atom_j,rhoCutoff_)) continue;
+      AtomsPair ij(atom_i,atom_j,10.0*Ao,20.0*Ao);
+      rhovar += g(ij);
+    }
+    rhos[i] = rhovar;
+    if (rhovar > 0.0)
+      dFs[i] = 0.5/(-sqrt(rhovar));
+  }
 }
 
 inline
@@ -206,60 +241,41 @@ Ackland::g(AtomsPair& ij, const Float V)  //PhiBig
   return PhiCapVal;
 }
 
-inline
-Float
-Ackland::F(Atom &atom1)
-{
-  Float rhovar = rho(atom1);
-  REQUIRE(rhovar >= 0.0);
-  Float F_var = -sqrt(rhovar);
-  if (rhovar != 0)
-  {
-    rho(atom1,0.5/F_var);
-  }
-  return F_var;
-}
-
-Float
-Ackland::rho(Atom &atom_i, const Float V)
-{
-  Float rhoij = 0.0;
-  for(size_t j = 0; j < NL(atom_i).size(); j++)
-  {
-    Atom& atom_j = *(NL(atom_i)[j]);
-    AtomsPair ij(atom_i,atom_j,10.0*Ao,20.0*Ao);
-    rhoij += g(ij,V);
-  }
-  return rhoij;
-}
-
 Ackland::Ackland():
   FManybody(),
+  rhos(),
+  dFs(),
   splines()
 {
-  handledElements.insert(Cu_EL);
-  handledElementPairs.insert(std::make_pair(Cu_EL,Cu_EL));
-  handledElementPairs.insert(std::make_pair(Cu_EL,DUMMY_EL));
-  handledElementPairs.insert(std::make_pair(DUMMY_EL,Cu_EL));
+  handleElement(Cu_EL);
+  handleElementPair(Cu_EL,Cu_EL);
+  handleElementPair(Cu_EL,DUMMY_EL);
+  handleElementPair(DUMMY_EL,Cu_EL);
 
-  handledElements.insert(Ag_EL);
-  handledElementPairs.insert(std::make_pair(Ag_EL,Ag_EL));
-  handledElementPairs.insert(std::make_pair(Ag_EL,DUMMY_EL));
-  handledElementPairs.insert(std::make_pair(DUMMY_EL,Ag_EL));
+  handleElement(Ag_EL);
+  handleElementPair(Ag_EL,Ag_EL);
+  handleElementPair(Ag_EL,DUMMY_EL);
+  handleElementPair(DUMMY_EL,Ag_EL);
 
-  handledElements.insert(Au_EL);
-  handledElementPairs.insert(std::make_pair(Au_EL,Au_EL));
-  handledElementPairs.insert(std::make_pair(Au_EL,DUMMY_EL));
-  handledElementPairs.insert(std::make_pair(DUMMY_EL,Au_EL));
+  handleElement(Au_EL);
+  handleElementPair(Au_EL,Au_EL);
+  handleElementPair(Au_EL,DUMMY_EL);
+  handleElementPair(DUMMY_EL,Au_EL);
 
-  handledElementPairs.insert(std::make_pair(Cu_EL,Ag_EL));
-  handledElementPairs.insert(std::make_pair(Ag_EL,Cu_EL));
+  handleElementPair(Cu_EL,Ag_EL);
+  handleElementPair(Ag_EL,Cu_EL);
 
-  handledElementPairs.insert(std::make_pair(Cu_EL,Au_EL));
-  handledElementPairs.insert(std::make_pair(Au_EL,Cu_EL));
+  handleElementPair(Cu_EL,Au_EL);
+  handleElementPair(Au_EL,Cu_EL);
 
-  handledElementPairs.insert(std::make_pair(Ag_EL,Au_EL));
-  handledElementPairs.insert(std::make_pair(Au_EL,Ag_EL));
+  handleElementPair(Ag_EL,Au_EL);
+  handleElementPair(Au_EL,Ag_EL);
+
+  for(size_t i = 0; i < SPECIES_size; ++i)
+    e2i_[i] = 0;
+  e2i_[ElementIDtoSpecies(Cu_EL)] = Cu;
+  e2i_[ElementIDtoSpecies(Ag_EL)] = Ag;
+  e2i_[ElementIDtoSpecies(Au_EL)] = Au;
 
   setupPotential();
 
@@ -369,6 +385,13 @@ Ackland::setupPotential()
   Rk_[Au][Au][1] = Rk_[Au][Au][1] = 1.1180065*a;
   Rk_[Au][Au][2] = Rk_[Au][Au][2] = 0.8660254*a;
 
+  for(size_t i = 0; i < ECOUNT; i++)
+    for(size_t j = 0; j < ECOUNT; j++)
+    {
+      rhoCutoff_[i][j] = std::min(Rk_[i][i][1],Rk_[j][j][1]);
+      cutoff_[i][j] = std::max(rk_[i][j][1],rhoCutoff_[i][j]);
+    }
+
 fillR_concat_();
 
   PRINT("Ackland interatomic potential configured.\n");
@@ -46,11 +46,19 @@ class Ackland : public FManybody
 {
 private:
   Float Phi(AtomsPair& ij);
-  Float F(Atom &atom1);
-  Float rho(Atom &atom1, const Float V = 0.0);
   Float g(AtomsPair& ij, const Float V = 0.0);
+/*
+  The densities are summed in a pass of their own, which also keeps the
+  derivatives F'(rho_i) of the embedding energy. The pair pass then
+  pushes the density derivatives of each pair once, weighted with
+  F'(rho_i)+F'(rho_j).
+*/
+  std::vector<Float> rhos;
+  std::vector<Float> dFs;
+  void fillDensities(AtomsArray& gl);
 public:
   virtual Float operator()(AtomsArray&);
+  void accumulateEnergy(AtomsArray& gl, size_t i, Float& Ei);
   void setupPotential();
 
   Ackland();
@@ -69,18 +77,23 @@ private:
 
   Spline* splines[ECOUNT][ECOUNT];
 
+// distances beyond which the density and both pair terms vanish
+  Float rhoCutoff_[ECOUNT][ECOUNT];
+  Float cutoff_[ECOUNT][ECOUNT];
+  bool withinCutoff(const Atom& atom1, const Atom& atom2,
+                    const Float cutoff[ECOUNT][ECOUNT]) const
+  {
+    return depos(atom1,atom2).module_squared() <
+      SQR(cutoff[e2i(atom1)][e2i(atom2)]);
+  }
+
   Float PhiCap(size_t a1_id, size_t a2_id, Float r) const;
   Float dPhiCap(size_t a1_id, size_t a2_id, Float r) const;
 
+  int e2i_[SPECIES_size];
   size_t e2i(const Atom &atom) const
   {
-    switch (atom.ID)
-    {
-      case Cu_EL : return Cu; break;
-      case Ag_EL : return Ag; break;
-      case Au_EL : return Au; break;
-      default : throw Exception("e2i() : unknown element");
-    };
+    return e2i_[atom.species];
   }
   Float rk(int i, const AtomsPair& ij) const
   {
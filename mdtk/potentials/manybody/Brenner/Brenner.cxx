@@ -172,9 +172,9 @@ Brenner::ExpTerm(AtomsPair& ij, AtomsPair& ik, const Float V)
     ij.r(Dertmp*V);
     ik.r(-Dertmp*V);
 /*
-    ij.atom1.grad += ij.dr(ij.atom1)*Dertmp*V;
-    ij.atom2.grad += ij.dr(ij.atom2)*Dertmp*V;
-    ik.atom2.grad += ij.dr(ik.atom2)*Dertmp*V;
+    gradient(ij.atom1) += ij.dr(ij.atom1)*Dertmp*V;
+    gradient(ij.atom2) += ij.dr(ij.atom2)*Dertmp*V;
+    gradient(ik.atom2) += ij.dr(ik.atom2)*Dertmp*V;
 */
   }
 
@@ -478,12 +478,18 @@ Brenner::Brenner(ParamSet parSet):
   funcH_CH((paramSet==POTENTIAL1)?0:1),
   funcF((paramSet==POTENTIAL1)?0:1)
 {
-  handledElements.insert(H_EL);
-  handledElements.insert(C_EL);
-  handledElementPairs.insert(std::make_pair(H_EL,C_EL));
-  handledElementPairs.insert(std::make_pair(C_EL,H_EL));
-  handledElementPairs.insert(std::make_pair(H_EL,H_EL));
-  handledElementPairs.insert(std::make_pair(C_EL,C_EL));
+  handleElement(H_EL);
+  handleElement(C_EL);
+  handleElementPair(H_EL,C_EL);
+  handleElementPair(C_EL,H_EL);
+  handleElementPair(H_EL,H_EL);
+  handleElementPair(C_EL,C_EL);
+
+  for(size_t i = 0; i < SPECIES_size; ++i)
+    e2i_[i] = 0;
+  e2i_[ElementIDtoSpecies(H_EL)] = H;
+  e2i_[ElementIDtoSpecies(C_EL)] = C;
+
   switch (paramSet)
   {
     case POTENTIAL1:  setupPotential1(); break;
@@ -135,14 +135,10 @@ private:
   void setupPotential1();
   void setupPotential2();
 
+  int e2i_[SPECIES_size];
   size_t e2i(const Atom &atom) const
   {
-    switch (atom.ID)
-    {
-      case H_EL : return H; break;
-      case C_EL : return C; break;
-      default : throw Exception("e2i() : unknown element");
-    };
+    return e2i_[atom.species];
   }
 
   Float Re(const AtomsPair& ij) const
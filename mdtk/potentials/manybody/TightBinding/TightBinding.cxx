@@ -30,29 +30,63 @@ namespace mdtk
 Float
 TightBinding::operator()(AtomsArray& gl)
 {
-  Float Ei = 0;
-  for(size_t ii = 0; ii < gl.size(); ii++)
+  fillDensities(gl);
+  return accumulateOverAtoms(*this,gl,&TightBinding::accumulateEnergy);
+}
+
+void
+TightBinding::accumulateEnergy(AtomsArray& gl, size_t ii, Float& Ei)
+{
+  Atom &atom_i = gl[ii];
+  if (isHandled(atom_i))
   {
-    Atom &atom_i = gl[ii];
-    if (isHandled(atom_i))
-    {
-      Ei += F(atom_i);
+    REQUIRE(rhos[ii] >= 0.0);
+    Ei += -c_*sqrt(rhos[ii]);
 
-      for(size_t jj = 0; jj < NL(atom_i).size(); jj++)
+    NeighbourRefs nli = NL(atom_i);
+    for(size_t jj = 0; jj < nli.size(); jj++)
+    {
+      Atom &atom_j = *(nli[jj]);
+      if (atom_i.globalIndex > atom_j.globalIndex) continue;
+      if (&atom_i != &atom_j)
       {
-        Atom &atom_j = *(NL(atom_i)[jj]);
-        if (atom_i.globalIndex > atom_j.globalIndex) continue;
-        if (&atom_i != &atom_j)
-        {
-          if (!probablyAreNeighbours(atom_i,atom_j)) continue;
-          AtomsPair ij(atom_i,atom_j,R(0,atom_i,atom_j),R(1,atom_i,atom_j));
-          Ei += Phi(ij);
-        }
+        if (!probablyAreNeighbours(atom_i,atom_j)) continue;
+        AtomsPair ij(atom_i,atom_j,R(0,atom_i,atom_j),R(1,atom_i,atom_j));
+        Ei += Phi(ij);
+        Float dF = dFs[ii]+dFs[atom_j.globalIndex];
+        if (dF != 0.0)
+          g(ij,dF);
       }
     }
   }
+}
 
-  return Ei;
+void
+TightBinding::fillDensities(AtomsArray& gl)
+{
+  rhos.assign(gl.size(),0.0);
+  dFs.assign(gl.size(),0.0);
+
+#ifdef MDTK_OPENMP
+#pragma omp parallel for num_threads(forceThreads()) schedule(static,FORCE_THREADS_CHUNK)
+#endif
+  for(int i = 0; i < int(gl.size()); i++)
+  {
+    Atom &atom_i = gl[i];
+    if (!isHandled(atom_i)) continue;
+    Float rhovar = 0.0;
+    NeighbourRefs nli = NL(atom_i);
+    for(size_t j = 0; j < nli.size(); j++)
+    {
+      Atom& atom_j = *(nli[j]);
+      if (!probablyAreNeighbours(atom_i,atom_j)) continue;
+      AtomsPair ij(atom_i,atom_j,R(0,atom_i,atom_j),R(1,atom_i,atom_j));
+      rhovar += g(ij);
+    }
+    rhos[i] = rhovar;
+    if (rhovar > 0.0)
+      dFs[i] = -c_/(2.0*sqrt(rhovar));
+  }
 }
 
 inline
@@ -129,42 +163,15 @@ TightBinding::g(AtomsPair& ij, const Float V)
   return fvar*Val;
 }
 
-inline
-Float
-TightBinding::F(Atom &atom1)
-{
-  Float rhovar = rho(atom1);
-  REQUIRE(rhovar >= 0.0);
-  if (rhovar != 0)
-  {
-    rho(atom1,-c_/(2.0*sqrt(rhovar)));
-  }
-  return -c_*sqrt(rhovar);
-}
-
-Float
-TightBinding::rho(Atom &atom_i, const Float V)
-{
-  Float rhoij = 0.0;
-  for(size_t j = 0; j < NL(atom_i).size(); j++)
-  {
-    Atom& atom_j = *(NL(atom_i)[j]);
-    if (!probablyAreNeighbours(atom_i,atom_j)) continue;
-    AtomsPair ij(atom_i,atom_j,R(0,atom_i,atom_j),R(1,atom_i,atom_j));
-    {
-      rhoij += g(ij,V);
-    }
-  }
-  return rhoij;
-}
-
 TightBinding::TightBinding():
-  FManybody()
+  FManybody(),
+  rhos(),
+  dFs()
 {
-  handledElements.insert(Cu_EL);
-  handledElementPairs.insert(std::make_pair(Cu_EL,Cu_EL));
-  handledElementPairs.insert(std::make_pair(Cu_EL,DUMMY_EL));
-  handledElementPairs.insert(std::make_pair(DUMMY_EL,Cu_EL));
+  handleElement(Cu_EL);
+  handleElementPair(Cu_EL,Cu_EL);
+  handleElementPair(Cu_EL,DUMMY_EL);
+  handleElementPair(DUMMY_EL,Cu_EL);
 
   setupPotential();
 
@@ -44,11 +44,18 @@ class TightBinding : public FManybody
 {
 private:
   Float Phi(AtomsPair& ij);
-  Float F(Atom &atom1);
-  Float rho(Atom &atom1, const Float V = 0.0);
   Float g(AtomsPair& ij, const Float V = 0.0);
+/*
+  Densities and the derivatives F'(rho_i) of the embedding energy, from
+  a pass of their own; the pair pass weights the density derivatives of
+  each pair with F'(rho_i)+F'(rho_j).
+*/
+  std::vector<Float> rhos;
+  std::vector<Float> dFs;
+  void fillDensities(AtomsArray& gl);
 public:
   virtual Float operator()(AtomsArray&);
+  void accumulateEnergy(AtomsArray& gl, size_t i, Float& Ei);
   void setupPotential();
 
   TightBinding();
@@ -34,22 +34,30 @@ using std::pow;
 FBM::FBM(Rcutoff rcutoff):
   FPairwise(rcutoff)
 {
-  handledElements.insert(Cu_EL);
-  handledElements.insert(Ar_EL);
-
-  handledElementPairs.insert(std::make_pair(Ar_EL,Cu_EL));
-  handledElementPairs.insert(std::make_pair(Cu_EL,Ar_EL));
-  handledElementPairs.insert(std::make_pair(Cu_EL,Cu_EL));
-
-  A3[Cu_EL][Cu_EL] = 22.565*1000.0*eV;
-    A3[Cu_EL][Cu_EL] = A3[Cu_EL][Cu_EL];
-  A4[Cu_EL][Cu_EL] = 50.88/(10.0*Ao);
-    A4[Cu_EL][Cu_EL] = A4[Cu_EL][Cu_EL];
-
-  A3[Cu_EL][Ar_EL] = 59.874*1000.0*eV;
-    A3[Ar_EL][Cu_EL] = A3[Cu_EL][Ar_EL];
-  A4[Cu_EL][Ar_EL] = 72.0/(10.0*Ao);
-    A4[Ar_EL][Cu_EL] = A4[Cu_EL][Ar_EL];
+  handleElement(Cu_EL);
+  handleElement(Ar_EL);
+
+  handleElementPair(Ar_EL,Cu_EL);
+  handleElementPair(Cu_EL,Ar_EL);
+  handleElementPair(Cu_EL,Cu_EL);
+
+  for(size_t i = 0; i < SPECIES_size; ++i)
+    for(size_t j = 0; j < SPECIES_size; ++j)
+    {
+      A3[i][j] = 0.0;
+      A4[i][j] = 0.0;
+    }
+
+  const int Cu = ElementIDtoSpecies(Cu_EL);
+  const int Ar = ElementIDtoSpecies(Ar_EL);
+
+  A3[Cu][Cu] = 22.565*1000.0*eV;
+  A4[Cu][Cu] = 50.88/(10.0*Ao);
+
+  A3[Cu][Ar] = 59.874*1000.0*eV;
+    A3[Ar][Cu] = A3[Cu][Ar];
+  A4[Cu][Ar] = 72.0/(10.0*Ao);
+    A4[Ar][Cu] = A4[Cu][Ar];
 }
 
 Float
@@ -59,40 +67,59 @@ FBM::F11(AtomsPair& ij, const Float V)
 
   if (V != 0.0)
   {
-    Float Der = -A3[ij.atom1.ID][ij.atom2.ID]*A4[ij.atom1.ID][ij.atom2.ID]*exp(-A4[ij.atom1.ID][ij.atom2.ID]*R);
+    Float Der = -A3[ij.atom1.species][ij.atom2.species]*A4[ij.atom1.species][ij.atom2.species]*exp(-A4[ij.atom1.species][ij.atom2.species]*R);
 
     ij.r(Der*V);
   }
 
-  return  A3[ij.atom1.ID][ij.atom2.ID]*exp(-A4[ij.atom1.ID][ij.atom2.ID]*R);
+  return  A3[ij.atom1.species][ij.atom2.species]*exp(-A4[ij.atom1.species][ij.atom2.species]*R);
+}
+
+Float
+FBM::pairEnergy(AtomsPair& ij)
+{
+  Float f = ij.f();
+  Float F11Val = F11(ij,f);
+//  if (V != 0)
+  ij.f(F11Val);
+  return F11Val*f;
 }
 
 Float
 FBM::operator()(AtomsArray& gl)
 {
-  Float Ei = 0;
-for(size_t i = 0; i < gl.size(); i++)
+  batches.resize(forceThreads());
+  return accumulateOverAtoms(*this,gl,&FBM::accumulateEnergy);
+}
+
+void
+FBM::pairKernel(PairBatch& b, unsigned char species1) const
 {
-  Atom& atom = gl[i];
-  AtomRefsContainer& nl = NL(atom);
-  for(size_t j = 0; j < nl.size(); j++)
+  const Float* a3 = A3[species1];
+  const Float* a4 = A4[species1];
+  const unsigned char* species = &b.species[0];
+  const Float* r = &b.r[0];
+  Float* E = &b.E[0];
+  Float* dE = &b.dE[0];
+  size_t n = b.size();
+  for(size_t k = 0; k < n; k++)
   {
-    Atom &atom_j = *(nl[j]);
-    if (atom.globalIndex > atom_j.globalIndex) continue;
-    if (isHandledPair(atom,atom_j))
-    if (&atom != &atom_j)
-    {
-      if (!probablyAreNeighbours(atom,atom_j)) continue;
-      AtomsPair ij(atom,atom_j,R(0),R(1));
-      Float f = ij.f();
-      Float F11Val = F11(ij,f);
-//      if (V != 0)
-      ij.f(F11Val);
-      Ei += F11Val*f;
-    }
+    Float A3_ = a3[species[k]];
+    Float A4_ = a4[species[k]];
+    Float x = exp(-A4_*r[k]);
+    dE[k] = -A3_*A4_*x;
+    E[k] = A3_*x;
   }
 }
-  return Ei;
+
+void
+FBM::accumulateEnergy(AtomsArray& gl, size_t i, Float& Ei)
+{
+  PairBatch& b = batch();
+  gatherPairs(gl,i,b);
+  if (b.size() == 0) return;
+  pairKernel(b,gl[i].species);
+  scatterPairs(gl[i],b,Ei);
 }
 
 } // namespace mdtk
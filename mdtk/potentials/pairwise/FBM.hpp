@@ -32,12 +32,15 @@ namespace mdtk
 class FBM : public FPairwise
 {
 private:
-  Float A3[EL_ID_size][EL_ID_size];
-  Float A4[EL_ID_size][EL_ID_size];
+  Float A3[SPECIES_size][SPECIES_size];
+  Float A4[SPECIES_size][SPECIES_size];
+  void pairKernel(PairBatch& b, unsigned char species1) const;
 public:
   Float F11(AtomsPair& ij, const Float V = 0.0);
+  Float pairEnergy(AtomsPair& ij);
 public:
   virtual Float operator()(AtomsArray&);
+  void accumulateEnergy(AtomsArray& gl, size_t i, Float& Ei);
   FBM(Rcutoff = Rcutoff());
 
   void SaveToStream(std::ostream& os, YAATK_FSTREAM_MODE smode)
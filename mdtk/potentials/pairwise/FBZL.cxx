@@ -32,8 +32,7 @@ using std::sqrt;
 using std::pow;
 
 FBZL::FBZL(Rcutoff rcutoff):
-  FPairwise(rcutoff),
-  AB_(0.53e-8)
+  FPairwise(rcutoff)
 {
   std::vector<ElementID> elements;
   elements.push_back(H_EL);
@@ -47,23 +46,40 @@ FBZL::FBZL(Rcutoff rcutoff):
   ions.push_back(Xe_EL);
 
   for(size_t i = 0; i < elements.size(); ++i)
-    handledElements.insert(elements[i]);
+    handleElement(elements[i]);
 
   for(size_t i = 0; i < ions.size(); ++i)
-    handledElements.insert(ions[i]);
+    handleElement(ions[i]);
 
   for(size_t i = 0; i < ions.size(); ++i)
     for(size_t j = 0; j < ions.size(); ++j)
     {
-      handledElementPairs.insert(std::make_pair(ions[i],ions[j]));
-      handledElementPairs.insert(std::make_pair(ions[j],ions[i]));
+      handleElementPair(ions[i],ions[j]);
+      handleElementPair(ions[j],ions[i]);
     }
 
   for(size_t i = 0; i < ions.size(); ++i)
     for(size_t j = 0; j < elements.size(); ++j)
     {
-      handledElementPairs.insert(std::make_pair(ions[i],elements[j]));
-      handledElementPairs.insert(std::make_pair(elements[j],ions[i]));
+      handleElementPair(ions[i],elements[j]);
+      handleElementPair(elements[j],ions[i]);
+    }
+
+  std::vector<ElementID> species(elements);
+  species.insert(species.end(),ions.begin(),ions.end());
+  REQUIRE(species.size() == ECOUNT);
+
+  for(size_t i = 0; i < SPECIES_size; ++i)
+    e2i_[i] = 0;
+  for(size_t i = 0; i < species.size(); ++i)
+    e2i_[ElementIDtoSpecies(species[i])] = i;
+
+  for(size_t i = 0; i < species.size(); ++i)
+    for(size_t j = 0; j < species.size(); ++j)
+    {
+      Atom atom1(species[i]); atom1.setAttributesByElementID();
+      Atom atom2(species[j]); atom2.setAttributesByElementID();
+      zbl_[i][j].setup(atom1.Z,atom2.Z);
     }
 }
 
@@ -74,56 +90,60 @@ FBZL::F11(AtomsPair& ij, const Float V)
 
   if (R > getRcutoff()) return 0.0;
 
-  Float ZA = ij.atom1.Z; Float ZB = ij.atom2.Z;
-
-  Float AS=8.8534e-1*AB_/(pow(ZA/e,Float(0.23))+pow(ZB/e,Float(0.23)));
-
-  Float Y=R/AS;
+  Float Der;
+  Float Val = zbl(ij)(R,Der);
 
   if (V != 0.0)
-  {
-    Float Der =
-          -ZA*ZB/(R*R)*(0.18175*exp(-3.1998*Y)+
-          0.50986*exp(-0.94229*Y)+
-          0.28022*exp(-0.4029*Y)+0.02817*exp(-0.20162*Y))-
-          ZA*ZB/(R*AS)*(0.18175*3.1998*exp(-3.1998*Y)+
-          0.50986*0.94229*exp(-0.94229*Y)+0.28022*0.4029*exp(-0.4029*Y)+
-          0.02817*0.20162*exp(-0.20162*Y));
-
     ij.r(Der*V);
-  }
 
-  return  ZA*ZB/R*(0.18175*exp(-3.1998*Y)+
-          0.50986*exp(-0.94229*Y)+
-          0.28022*exp(-0.4029*Y)+0.02817*exp(-0.20162*Y));
+  return Val;
+}
+
+Float
+FBZL::pairEnergy(AtomsPair& ij)
+{
+  Float f = ij.f();
+  Float F11Val = F11(ij,f);
+//  if (V != 0)
+  ij.f(F11Val);
+  return F11Val*f;
 }
 
 Float
 FBZL::operator()(AtomsArray& gl)
 {
-  Float Ei = 0;
-for(size_t i = 0; i < gl.size(); i++)
+  batches.resize(forceThreads());
+  return accumulateOverAtoms(*this,gl,&FBZL::accumulateEnergy);
+}
+
+void
+FBZL::pairKernel(PairBatch& b, unsigned char species1) const
 {
-  Atom& atom = gl[i];
-  AtomRefsContainer& nl = NL(atom);
-  for(size_t j = 0; j < nl.size(); j++)
+  const ZBL* zbl = zbl_[e2i_[species1]];
+  const unsigned char* species = &b.species[0];
+  const Float* r = &b.r[0];
+  Float* E = &b.E[0];
+  Float* dE = &b.dE[0];
+  Float Rc = getRcutoff();
+  size_t n = b.size();
+  for(size_t k = 0; k < n; k++)
   {
-    Atom &atom_j = *(nl[j]);
-    if (atom.globalIndex > atom_j.globalIndex) continue;
-    if (isHandledPair(atom,atom_j))
-    if (&atom != &atom_j)
-    {
-      if (!probablyAreNeighbours(atom,atom_j)) continue;
-      AtomsPair ij(atom,atom_j,R(0),R(1));
-      Float f = ij.f();
-      Float F11Val = F11(ij,f);
-//      if (V != 0)
-      ij.f(F11Val);
-      Ei += F11Val*f;
-    }
+    Float Der;
+    Float Val = zbl[e2i_[species[k]]](r[k],Der);
+    bool inside = !(r[k] > Rc);
+    E[k] = inside?Val:0.0;
+    dE[k] = inside?Der:0.0;
   }
 }
-  return Ei;
+
+void
+FBZL::accumulateEnergy(AtomsArray& gl, size_t i, Float& Ei)
+{
+  PairBatch& b = batch();
+  gatherPairs(gl,i,b);
+  if (b.size() == 0) return;
+  pairKernel(b,gl[i].species);
+  scatterPairs(gl[i],b,Ei);
 }
 
 } // namespace mdtk
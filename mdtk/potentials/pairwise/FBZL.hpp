@@ -25,6 +25,7 @@
 #define mdtk_FBZL_hpp
 
 #include "FPairwise.hpp"
+#include "ZBL.hpp"
 
 namespace mdtk
 {
@@ -32,11 +33,20 @@ namespace mdtk
 class FBZL : public FPairwise
 {
 private:
-  Float AB_;
+  enum {ECOUNT = 7};
+  int e2i_[SPECIES_size];
+  ZBL zbl_[ECOUNT][ECOUNT];
+  const ZBL& zbl(const AtomsPair& ij) const
+  {
+    return zbl_[e2i_[ij.atom1.species]][e2i_[ij.atom2.species]];
+  }
+  void pairKernel(PairBatch& b, unsigned char species1) const;
 public:
   Float F11(AtomsPair& ij, const Float V = 0.0);
+  Float pairEnergy(AtomsPair& ij);
 public:
   virtual Float operator()(AtomsArray&);
+  void accumulateEnergy(AtomsArray& gl, size_t i, Float& Ei);
   FBZL(Rcutoff = Rcutoff());
 
   void SaveToStream(std::ostream& os, YAATK_FSTREAM_MODE smode)
@@ -22,6 +22,7 @@
 
 #include "FLJ.hpp"
 #include <iostream>
+#include <algorithm>
 
 namespace mdtk
 {
@@ -45,18 +46,25 @@ FLJ::FLJ(Rcutoff rcutoff):
   elements2.push_back(Au_EL);
 
   for(size_t i = 0; i < elements1.size(); ++i)
-    handledElements.insert(elements1[i]);
+    handleElement(elements1[i]);
 
   for(size_t i = 0; i < elements2.size(); ++i)
-    handledElements.insert(elements2[i]);
+    handleElement(elements2[i]);
 
   for(size_t i = 0; i < elements1.size(); ++i)
     for(size_t j = 0; j < elements2.size(); ++j)
     {
-      handledElementPairs.insert(std::make_pair(elements1[i],elements2[j]));
-      handledElementPairs.insert(std::make_pair(elements2[j],elements1[i]));
+      handleElementPair(elements1[i],elements2[j]);
+      handleElementPair(elements2[j],elements1[i]);
     }
 
+  for(size_t i = 0; i < SPECIES_size; ++i)
+    e2i_[i] = 0;
+  e2i_[ElementIDtoSpecies(H_EL)] = H;
+  e2i_[ElementIDtoSpecies(C_EL)] = C;
+  e2i_[ElementIDtoSpecies(Cu_EL)] = Cu;
+  e2i_[ElementIDtoSpecies(Au_EL)] = Au;
+
   if (0) // disable this set of parameters
   {
 //  See [D.E. Ellis et al., Materials Science in Semiconductor
@@ -191,30 +199,11 @@ Atom& atom2 = atoms[j];
 
   r = x[0];
 
-  Float VZBL = 0.0;
-  Float DerVZBL = 0.0;
-  {
-  Float AB_ = 0.53e-8;
-
-  Float ZA = atom1.Z; Float ZB = atom2.Z;
-
-  Float AS=8.8534e-1*AB_/(pow(ZA/e,Float(0.23))+pow(ZB/e,Float(0.23)));
+  ZBL& zbl = zbl_[e2i(atom1)][e2i(atom2)];
+  zbl.setup(atom1.Z,atom2.Z);
 
-  Float Y=r/AS;
-
-  VZBL=   ZA*ZB/r*(0.18175*exp(-3.1998*Y)+
-          0.50986*exp(-0.94229*Y)+
-          0.28022*exp(-0.4029*Y)+0.02817*exp(-0.20162*Y));
-
-  DerVZBL =
-          -ZA*ZB/(r*r)*(0.18175*exp(-3.1998*Y)+
-          0.50986*exp(-0.94229*Y)+
-          0.28022*exp(-0.4029*Y)+0.02817*exp(-0.20162*Y))-
-          ZA*ZB/(r*AS)*(0.18175*3.1998*exp(-3.1998*Y)+
-          0.50986*0.94229*exp(-0.94229*Y)+0.28022*0.4029*exp(-0.4029*Y)+
-          0.02817*0.20162*exp(-0.20162*Y));
-
-  }
+  Float DerVZBL = 0.0;
+  Float VZBL = zbl(r,DerVZBL);
   v[0] = VZBL;
   dvdx[0] = DerVZBL/* = -1.5*/;
 
@@ -254,30 +243,13 @@ FLJ::VLJ(AtomsPair& ij)
   Spline& spline = *(splines[e2i(ij.atom1)][e2i(ij.atom2)]);
   if (r < spline.x1())
   {
-  Float AB_ = 0.53e-8;
-
-  Float ZA = ij.atom1.Z; Float ZB = ij.atom2.Z;
-
-  Float AS=8.8534e-1*AB_/(pow(ZA/e,Float(0.23))+pow(ZB/e,Float(0.23)));
-
-  Float Y=r/AS;
+    Float Der;
+    Float Val = zbl_[e2i(ij.atom1)][e2i(ij.atom2)](r,Der);
 
 //  if (V != 0.0)
-  {
-    Float Der =
-          -ZA*ZB/(r*r)*(0.18175*exp(-3.1998*Y)+
-          0.50986*exp(-0.94229*Y)+
-          0.28022*exp(-0.4029*Y)+0.02817*exp(-0.20162*Y))-
-          ZA*ZB/(r*AS)*(0.18175*3.1998*exp(-3.1998*Y)+
-          0.50986*0.94229*exp(-0.94229*Y)+0.28022*0.4029*exp(-0.4029*Y)+
-          0.02817*0.20162*exp(-0.20162*Y));
-
     ij.r(Der);
-  }
 
-  return  ZA*ZB/r*(0.18175*exp(-3.1998*Y)+
-          0.50986*exp(-0.94229*Y)+
-          0.28022*exp(-0.4029*Y)+0.02817*exp(-0.20162*Y));
+    return Val;
   }
   else
   {
@@ -319,25 +291,77 @@ FLJ::VLJ(AtomsPair& ij)
 Float
 FLJ::operator()(AtomsArray& gl)
 {
-  Float Ei = 0;
-for(size_t i = 0; i < gl.size(); i++)
+  batches.resize(forceThreads());
+  return accumulateOverAtoms(*this,gl,&FLJ::accumulateEnergy);
+}
+
+/*
+  The Lennard-Jones terms are computed for the whole batch first; the
+  few pairs closer than the end of the joining spline are redone with
+  ZBL or the spline afterwards and, as in VLJ, are not cut off.
+*/
+void
+FLJ::pairKernel(PairBatch& b, unsigned char species1) const
 {
-  Atom& atom = gl[i];
-  AtomRefsContainer& nl = NL(atom);
-  for(size_t j = 0; j < nl.size(); j++)
+  const int i1 = e2i_[species1];
+  const unsigned char* species = &b.species[0];
+  const Float* r = &b.r[0];
+  Float* sigma_ij = &b.p1[0];
+  Float* epsilon_ij = &b.p2[0];
+  Float* E = &b.E[0];
+  Float* dE = &b.dE[0];
+  size_t n = b.size();
+  for(size_t k = 0; k < n; k++)
   {
-    Atom &atom_j = *(nl[j]);
-    if (atom.globalIndex > atom_j.globalIndex) continue;
-    if (isHandledPair(atom,atom_j))
-    if (&atom != &atom_j)
+    int i2 = e2i_[species[k]];
+    sigma_ij[k] = sigma_[i1][i2];
+    epsilon_ij[k] = epsilon_[i1][i2];
+  }
+// the pairs redone below get their terms at no less than rLJmin, so
+// that the batch stays finite at collision distances
+  Float rLJmin = 0.0;
+#ifndef  LJ_HANDLE_SHORTRANGE
+  rLJmin = splines[i1][0]->x1();
+  for(size_t i2 = 1; i2 < ECOUNT; i2++)
+    rLJmin = std::min(rLJmin,splines[i1][i2]->x1());
+#endif
+  for(size_t k = 0; k < n; k++)
+  {
+    Float rk = (r[k] < rLJmin)?rLJmin:r[k];
+    Float s_div_r    = sigma_ij[k]/rk;
+    Float s_div_r_6  = s_div_r;
+    for(int i = 2; i <= 6; i++) s_div_r_6 *= s_div_r;
+    Float s_div_r_12 = s_div_r_6*s_div_r_6;
+    E[k] = 4.0*epsilon_ij[k]*(s_div_r_12-s_div_r_6);
+    dE[k] = 4.0*epsilon_ij[k]*(-12.0*s_div_r_12/rk+6.0*s_div_r_6/rk);
+  }
+#ifndef  LJ_HANDLE_SHORTRANGE
+  for(size_t k = 0; k < n; k++)
+  {
+    int i2 = e2i_[species[k]];
+    const Spline& spline = *(splines[i1][i2]);
+    if (!(r[k] < spline.x2())) continue;
+    if (r[k] < spline.x1())
+      E[k] = zbl_[i1][i2](r[k],dE[k]);
+    else
     {
-      if (!probablyAreNeighbours(atom,atom_j)) continue;
-      AtomsPair ij(atom,atom_j,R(0),R(1));
-      Ei += VLJ(ij);
+      dE[k] = spline.der(r[k]);
+      E[k] = spline(r[k]);
     }
+    b.f[k] = 1.0;
+    b.df[k] = 0.0;
   }
+#endif
 }
-  return Ei;
+
+void
+FLJ::accumulateEnergy(AtomsArray& gl, size_t i, Float& Ei)
+{
+  PairBatch& b = batch();
+  gatherPairs(gl,i,b);
+  if (b.size() == 0) return;
+  pairKernel(b,gl[i].species);
+  scatterPairs(gl[i],b,Ei);
 }
 
 } // namespace mdtk
@@ -25,6 +25,7 @@
 #define mdtk_FLJ_hpp
 
 #include "FPairwise.hpp"
+#include "ZBL.hpp"
 #include <mdtk/Spline.hpp>
 
 //#define  LJ_HANDLE_SHORTRANGE
@@ -37,6 +38,7 @@ class FLJ : public FPairwise
 private:
 public:
   Float VLJ(AtomsPair& ij);
+  Float pairEnergy(AtomsPair& ij) {return VLJ(ij);}
 
   enum {ECOUNT = 4};
   enum {Cu = 0};
@@ -54,23 +56,20 @@ public:
   {
     return epsilon_[e2i(ij.atom1)][e2i(ij.atom2)];
   }
+  int e2i_[SPECIES_size];
   size_t e2i(const Atom &atom) const
   {
-    switch (atom.ID)
-    {
-      case H_EL : return H; break;
-      case C_EL : return C; break;
-      case Cu_EL : return Cu; break;
-      case Au_EL : return Au; break;
-      default : throw Exception("e2i() : unknown element");
-    };
+    return e2i_[atom.species];
   }
 
   Spline* splines[ECOUNT][ECOUNT];
+  ZBL zbl_[ECOUNT][ECOUNT];
   void fillR_concat_();
+  void pairKernel(PairBatch& b, unsigned char species1) const MDTK_PAIR_KERNEL;
 
 public:
   virtual Float operator()(AtomsArray&);
+  void accumulateEnergy(AtomsArray& gl, size_t i, Float& Ei);
   FLJ(Rcutoff = Rcutoff());
   virtual ~FLJ();
 
@@ -30,6 +30,67 @@ FPairwise::FPairwise(Rcutoff rcutoff):
   rc(rcutoff)
 {
   nl.Rcutoff = getRcutoff();
+  nl.half = true;
+}
+
+void
+FPairwise::gatherPairs(AtomsArray& gl, size_t i, PairBatch& b)
+{
+  b.clear();
+  Atom& atom = gl[i];
+  NeighbourRefs nl = NL(atom);
+  for(size_t j = 0; j < nl.size(); j++)
+  {
+    Atom &atom_j = *(nl[j]);
+    if (isHandledPair(atom,atom_j))
+    if (&atom != &atom_j)
+    {
+      if (!probablyAreNeighbours(atom,atom_j)) continue;
+      AtomsPair ij(atom,atom_j,R(0),R(1));
+      PairGeometry g = ij.geometry();
+      b.atoms.push_back(&atom_j);
+      b.species.push_back(atom_j.species);
+      b.unit.push_back(g.unit);
+      b.r.push_back(g.r);
+      b.f.push_back(g.f);
+      b.df.push_back(g.df);
+    }
+  }
+  b.p1.resize(b.size());
+  b.p2.resize(b.size());
+  b.E.resize(b.size());
+  b.dE.resize(b.size());
+}
+
+/*
+  Applies the cutoff function to the batch evaluated by the potential
+  and pushes the derivatives to the atoms pair by pair, in the order
+  of the neighbour list, just as pairEnergy would.
+*/
+void
+FPairwise::scatterPairs(Atom& atom, const PairBatch& b, Float& Ei) const
+{
+  for(size_t k = 0; k < b.size(); k++)
+  {
+    Atom& atom_j = *b.atoms[k];
+    const Vector3D& unit = b.unit[k];
+    Float V = b.dE[k]*b.f[k];
+    if (V != 0.0)
+    {
+      gradient(atom) += unit*V;
+      gradient(atom_j) += (-unit)*V;
+    }
+    if (b.df[k] != 0.0)
+    {
+      V = b.E[k]*b.df[k];
+      if (V != 0.0)
+      {
+        gradient(atom) += unit*V;
+        gradient(atom_j) += (-unit)*V;
+      }
+    }
+    Ei += b.E[k]*b.f[k];
+  }
 }
 
 }
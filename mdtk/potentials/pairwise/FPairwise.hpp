@@ -24,6 +24,25 @@
 #define mdtk_FPairwise_hpp
 
 #include <mdtk/potentials/FGeneral.hpp>
+#include <vector>
+
+/*
+  A batch kernel that vectorizes, i.e. calls no exp() or other library
+  function per pair, can be compiled for AVX-512, AVX2 and the baseline
+  instruction set where GCC supports function multiversioning, and the
+  clone matching the CPU is chosen at load time. Contraction into FMA
+  is disabled so that every clone gives the same bits as the scalar
+  code. Define MDTK_NO_SIMD_DISPATCH to build the baseline only.
+*/
+#if defined(__GNUC__) && !defined(__clang__) && !defined(__INTEL_COMPILER) \
+    && __GNUC__ >= 6 && defined(__x86_64__) && defined(__ELF__) \
+    && !defined(MDTK_NO_SIMD_DISPATCH)
+#define MDTK_PAIR_KERNEL \
+  __attribute__((target_clones("avx512f","avx2","default"), \
+                 optimize("fp-contract=off")))
+#else
+#define MDTK_PAIR_KERNEL
+#endif
 
 namespace mdtk
 {
@@ -49,16 +68,57 @@ struct Rcutoff
   }
 };
 
+/*
+  The neighbours of an atom within the cutoff, gathered into flat arrays
+  so that a potential can evaluate the energies E and their derivatives
+  by distance dE for all of them in one loop without branches per pair.
+*/
+struct PairBatch
+{
+  std::vector<Atom*> atoms;
+  std::vector<unsigned char> species;
+  std::vector<Vector3D> unit;
+  std::vector<Float> r;
+  std::vector<Float> f;
+  std::vector<Float> df;
+// parameters of the pairs, looked up by the potential
+  std::vector<Float> p1;
+  std::vector<Float> p2;
+  std::vector<Float> E;
+  std::vector<Float> dE;
+  size_t size() const {return r.size();}
+  void clear()
+  {
+    atoms.clear();
+    species.clear();
+    unit.clear();
+    r.clear();
+    f.clear();
+    df.clear();
+  }
+};
+
 class FPairwise : public FGeneral
 {
 protected:
   Rcutoff rc;
   Float R(int i, const Atom &, const Atom &) const { return rc.R[i]; }
   Float R(int i) const { return rc.R[i]; }
+// one batch per force thread, sized by operator() of the potential
+  std::vector<PairBatch> batches;
+  PairBatch& batch()
+  {
+    return batches[(batches.size() == 1)?0:forceThread()];
+  }
+  void gatherPairs(AtomsArray& gl, size_t i, PairBatch& b);
+  void scatterPairs(Atom& atom, const PairBatch& b, Float& Ei) const;
 public:
   Float getRcutoff() const {return rc.R[1];};
+  Rcutoff getRcutoffs() const {return rc;}
 public:
   FPairwise(Rcutoff = Rcutoff());
+// energy of the pair ij, its derivatives pushed to the atoms
+  virtual Float pairEnergy(AtomsPair& ij) = 0;
   virtual void onTouch(const Atom&) {}
   void SaveToStream(std::ostream& os, YAATK_FSTREAM_MODE smode)
   {
@@ -0,0 +1,208 @@
+/*
+   Tabulated evaluation of pairwise interatomic potentials.
+
+   Copyright (C) 2013 Oleksandr Yermolenko
+   <oleksandr.yermolenko@gmail.com>
+
+   This file is part of MDTK, the Molecular Dynamics Toolkit.
+
+   MDTK is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   MDTK is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with MDTK.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "FTabulated.hpp"
+#include <iostream>
+
+namespace mdtk
+{
+
+// finest grid step tried before giving up on the tolerance
+#define FTABULATED_MIN_STEP (1e-5*Ao)
+
+FTabulated::FTabulated(FPairwise* analyticPotential,
+                       Float tol, Float r_min):
+  FPairwise(analyticPotential->getRcutoffs()),
+  analytic(analyticPotential),
+  tolerance(tol),
+  rmin(r_min),
+  tables()
+{
+  REQUIRE(tolerance > 0.0);
+  REQUIRE(rmin > 0.0 && rmin < getRcutoff());
+
+  std::set<ElementID>::const_iterator e;
+  for(e = analytic->handledElements.begin();
+      e != analytic->handledElements.end(); ++e)
+    handleElement(*e);
+
+  std::set<std::pair<ElementID,ElementID> >::const_iterator p;
+  for(p = analytic->handledElementPairs.begin();
+      p != analytic->handledElementPairs.end(); ++p)
+    handleElementPair(p->first,p->second);
+
+  for(size_t i = 0; i < SPECIES_size; i++)
+    for(size_t j = 0; j < SPECIES_size; j++)
+      tableIndex[i][j] = -1;
+
+  for(p = handledElementPairs.begin(); p != handledElementPairs.end(); ++p)
+  {
+    ElementID id1 = p->first;
+    ElementID id2 = p->second;
+    if (handledElements.find(id1) == handledElements.end() ||
+        handledElements.find(id2) == handledElements.end())
+      continue;
+    int s1 = ElementIDtoSpecies(id1);
+    int s2 = ElementIDtoSpecies(id2);
+// the pair terms are symmetric, so (id2,id1) shares the table
+    if (tableIndex[s1][s2] >= 0)
+      continue;
+
+    Table t;
+    Float step = 0.01*Ao;
+    fill(t,id1,id2,step);
+    while (maxError(t,id1,id2) > tolerance)
+    {
+      step /= 2.0;
+      if (step < FTABULATED_MIN_STEP)
+        throw Exception("FTabulated : tolerance can not be reached");
+      fill(t,id1,id2,step);
+    }
+    tableIndex[s1][s2] = tables.size();
+    tableIndex[s2][s1] = tables.size();
+    tables.push_back(t);
+  }
+
+  REQUIRE(selfCheck() <= tolerance);
+
+  PRINT("Tabulated pairwise interatomic potential configured.\n");
+}
+
+FTabulated::~FTabulated()
+{
+  delete analytic;
+}
+
+/*
+  Energy and its derivative for a pair of atoms of the given elements
+  at the distance r, from the analytic potential.
+*/
+void
+FTabulated::sample(ElementID id1, ElementID id2, Float r, Float& E, Float& dE)
+{
+  Atom atom1(id1,Vector3D(0.0,0.0,0.0));
+  Atom atom2(id2,Vector3D(r,0.0,0.0));
+  atom1.setAttributesByElementID();
+  atom2.setAttributesByElementID();
+  atom1.grad = 0.0;
+  atom2.grad = 0.0;
+
+  AtomsPair ij(atom1,atom2,R(0),R(1));
+  E = analytic->pairEnergy(ij);
+  dE = atom2.grad.x;
+}
+
+/*
+  Cubic Hermite coefficients per interval, in the local coordinate
+  x = (r-r_k)/step; one interval past the cutoff is kept so that the
+  lookup needs no bounds check.
+*/
+void
+FTabulated::fill(Table& t, ElementID id1, ElementID id2, Float step)
+{
+  size_t n = size_t((getRcutoff()-rmin)/step)+2;
+  t.step = step;
+  t.invStep = 1.0/step;
+  t.coeffs.resize(4*n);
+
+  Float E0, dE0;
+  sample(id1,id2,rmin,E0,dE0);
+  for(size_t k = 0; k < n; k++)
+  {
+    Float E1, dE1;
+    sample(id1,id2,rmin+(k+1)*step,E1,dE1);
+    Float* c = &t.coeffs[4*k];
+    c[0] = E0;
+    c[1] = step*dE0;
+    c[2] = 3.0*(E1-E0)-step*(2.0*dE0+dE1);
+    c[3] = 2.0*(E0-E1)+step*(dE0+dE1);
+    E0 = E1;
+    dE0 = dE1;
+  }
+}
+
+Float
+FTabulated::maxError(const Table& t, ElementID id1, ElementID id2)
+{
+  Float maxErr = 0.0;
+  size_t n = t.coeffs.size()/4-1;
+  for(size_t k = 0; k < n; k++)
+    for(int q = 1; q <= 3; q++)
+    {
+      Float r = rmin+(k+0.25*q)*t.step;
+      if (r > getRcutoff()) break;
+
+      Float E, dE;
+      sample(id1,id2,r,E,dE);
+      Float dEtab;
+      Float Etab = lookup(t,r,dEtab);
+
+      maxErr = std::max(maxErr,fabs(Etab-E)/(fabs(E)+1.0*eV));
+      maxErr = std::max(maxErr,fabs(dEtab-dE)/(fabs(dE)+1.0*eV/Ao));
+    }
+  return maxErr;
+}
+
+/*
+  Largest error of the tables against the analytic form, measured the
+  same way as the tolerance.
+*/
+Float
+FTabulated::selfCheck()
+{
+  Float maxErr = 0.0;
+  std::set<std::pair<ElementID,ElementID> >::const_iterator p;
+  for(p = handledElementPairs.begin(); p != handledElementPairs.end(); ++p)
+  {
+    int t = tableIndex[ElementIDtoSpecies(p->first)]
+                      [ElementIDtoSpecies(p->second)];
+    if (t >= 0)
+      maxErr = std::max(maxErr,maxError(tables[t],p->first,p->second));
+  }
+  return maxErr;
+}
+
+Float
+FTabulated::operator()(AtomsArray& gl)
+{
+  return accumulateOverAtoms(*this,gl,&FTabulated::accumulateEnergy);
+}
+
+void
+FTabulated::accumulateEnergy(AtomsArray& gl, size_t i, Float& Ei)
+{
+  Atom& atom = gl[i];
+  NeighbourRefs nl = NL(atom);
+  for(size_t j = 0; j < nl.size(); j++)
+  {
+    Atom &atom_j = *(nl[j]);
+    if (isHandledPair(atom,atom_j))
+    if (&atom != &atom_j)
+    {
+      if (!probablyAreNeighbours(atom,atom_j)) continue;
+      AtomsPair ij(atom,atom_j,R(0),R(1));
+      Ei += pairEnergy(ij);
+    }
+  }
+}
+
+} // namespace mdtk
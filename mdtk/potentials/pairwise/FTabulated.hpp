@@ -0,0 +1,115 @@
+/*
+   Tabulated evaluation of pairwise interatomic potentials (header file).
+
+   Copyright (C) 2013 Oleksandr Yermolenko
+   <oleksandr.yermolenko@gmail.com>
+
+   This file is part of MDTK, the Molecular Dynamics Toolkit.
+
+   MDTK is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   MDTK is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with MDTK.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef mdtk_FTabulated_hpp
+#define mdtk_FTabulated_hpp
+
+#include "FPairwise.hpp"
+
+namespace mdtk
+{
+
+/*
+  Evaluates a pairwise potential from tables instead of its analytic
+  form. At construction the energy and its derivative are sampled on a
+  uniform r grid for every handled pair of elements, and the grid is
+  refined until the cubic Hermite interpolation between the samples is
+  within tolerance of the analytic form, relative to |E|+1 eV and
+  |dE/dr|+1 eV/Ao. Pairs closer than rmin, and pairs of elements the
+  analytic potential does not list as handled, are left to the analytic
+  form.
+
+  A potential opts in by being wrapped, e.g.
+    pot = new FTabulated(new FBZL(Rcutoff(5.0*Ao,5.5*Ao)));
+  The wrapper takes over the handled elements and the cutoff, and owns
+  the analytic potential.
+*/
+class FTabulated : public FPairwise
+{
+  FPairwise* analytic;
+  Float tolerance;
+  Float rmin;
+
+  struct Table
+  {
+    Float step;
+    Float invStep;
+    std::vector<Float> coeffs;
+  };
+  std::vector<Table> tables;
+  int tableIndex[SPECIES_size][SPECIES_size];
+
+  Float lookup(const Table& t, Float r, Float& dE) const;
+  void sample(ElementID id1, ElementID id2, Float r, Float& E, Float& dE);
+  void fill(Table& t, ElementID id1, ElementID id2, Float step);
+  Float maxError(const Table& t, ElementID id1, ElementID id2);
+public:
+  Float pairEnergy(AtomsPair& ij);
+  virtual Float operator()(AtomsArray&);
+  void accumulateEnergy(AtomsArray& gl, size_t i, Float& Ei);
+  Float selfCheck();
+
+  FTabulated(FPairwise* analyticPotential,
+             Float tolerance = 1e-6, Float rmin = 0.2*Ao);
+  virtual ~FTabulated();
+
+  void SaveToStream(std::ostream& os, YAATK_FSTREAM_MODE smode)
+  {
+    FPairwise::SaveToStream(os,smode);
+  }
+  void LoadFromStream(std::istream& is, YAATK_FSTREAM_MODE smode)
+  {
+    FPairwise::LoadFromStream(is,smode);
+  }
+};
+
+inline
+Float
+FTabulated::lookup(const Table& t, Float r, Float& dE) const
+{
+  Float x = (r-rmin)*t.invStep;
+  size_t k = size_t(x);
+  x -= k;
+  const Float* c = &t.coeffs[4*k];
+
+  dE = (c[1]+x*(2.0*c[2]+x*3.0*c[3]))*t.invStep;
+  return c[0]+x*(c[1]+x*(c[2]+x*c[3]));
+}
+
+inline
+Float
+FTabulated::pairEnergy(AtomsPair& ij)
+{
+  Float r = ij.r();
+  int t = tableIndex[ij.atom1.species][ij.atom2.species];
+  if (r < rmin || t < 0)
+    return analytic->pairEnergy(ij);
+
+  Float dE;
+  Float E = lookup(tables[t],r,dE);
+  ij.r(dE);
+  return E;
+}
+
+} // namespace mdtk
+
+#endif
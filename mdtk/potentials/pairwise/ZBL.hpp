@@ -0,0 +1,71 @@
+/*
+   The universal Ziegler-Biersack-Littmark screened repulsion.
+
+   Copyright (C) 2013 Oleksandr Yermolenko
+   <oleksandr.yermolenko@gmail.com>
+
+   This file is part of MDTK, the Molecular Dynamics Toolkit.
+
+   MDTK is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   MDTK is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with MDTK.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef mdtk_ZBL_hpp
+#define mdtk_ZBL_hpp
+
+#include <mdtk/consts.hpp>
+#include <cmath>
+
+namespace mdtk
+{
+
+/*
+  ZBL repulsion of a pair of nuclei. The charge product and the
+  screening length depend on the pair only, so they are set up once;
+  the four exponentials of the screening function are shared by the
+  value and the derivative.
+*/
+struct ZBL
+{
+  Float ZZ;
+  Float AS;
+
+  ZBL() : ZZ(0.0), AS(1.0) {}
+
+  void setup(Float ZA, Float ZB)
+  {
+    const Float AB_ = 0.53e-8;
+    ZZ = ZA*ZB;
+    AS = 8.8534e-1*AB_/(std::pow(ZA/e,Float(0.23))+std::pow(ZB/e,Float(0.23)));
+  }
+
+  Float operator()(Float r, Float& Der) const
+  {
+    Float Y = r/AS;
+
+    Float e1 = 0.18175*std::exp(-3.1998*Y);
+    Float e2 = 0.50986*std::exp(-0.94229*Y);
+    Float e3 = 0.28022*std::exp(-0.4029*Y);
+    Float e4 = 0.02817*std::exp(-0.20162*Y);
+
+    Float phi = e1+e2+e3+e4;
+    Float dphi = 3.1998*e1+0.94229*e2+0.4029*e3+0.20162*e4;
+
+    Der = -ZZ/(r*r)*phi-ZZ/(r*AS)*dphi;
+    return ZZ/r*phi;
+  }
+};
+
+} // namespace mdtk
+
+#endif